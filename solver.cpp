@@ -0,0 +1,572 @@
+/*
+Sudoku Solver Using AI
+Solver library: the parts of sudoku.h that are not templates, and the Solver object for each board size
+*/
+
+#include "sudoku.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+namespace sudoku
+{
+
+bool cpuHasAvx2()
+{
+#ifdef HAVE_AVX2_KERNELS
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+bool useAvx2 = cpuHasAvx2();
+
+template <size_t BOX>
+Solver<BOX>::Solver(const SolveOptions& options)
+    : ctx(make_unique<typename Sudoku<BOX>::SearchContext>())
+{
+    ctx->options = options;
+}
+
+template <size_t BOX>
+void Solver<BOX>::setOptions(const SolveOptions& options)
+{
+    ctx->options = options;
+}
+
+template <size_t BOX>
+const SolveOptions& Solver<BOX>::options() const
+{
+    return ctx->options;
+}
+
+template <size_t BOX>
+void Solver<BOX>::setSeed(uint64_t seed)
+{
+    ctx->rngState = seed;
+}
+
+template <size_t BOX>
+bool Solver<BOX>::load(const uint8_t* cells)
+{
+    for (size_t cell = 0; cell < CELLS; ++cell)
+    {
+        if (cells[cell] > SIZE)
+        {
+            return false;
+        }
+        ctx->board.cells[cell] = cells[cell];
+    }
+    return true;
+}
+
+template <size_t BOX>
+bool Solver<BOX>::solve(uint8_t* cells)
+{
+    ctx->aborted = false;
+    if (!load(cells))
+    {
+        return false;
+    }
+    ctx->options.solutionLimit = 1;
+    if (Sudoku<BOX>::solveBoard(*ctx) == 0)
+    {
+        return false;
+    }
+    copy(ctx->board.cells, ctx->board.cells + CELLS, cells);
+    return true;
+}
+
+template <size_t BOX>
+size_t Solver<BOX>::count(const uint8_t* cells, size_t limit)
+{
+    ctx->aborted = false;
+    if (!load(cells))
+    {
+        return 0;
+    }
+    ctx->options.solutionLimit = limit;
+    return Sudoku<BOX>::solveBoard(*ctx);
+}
+
+template <size_t BOX>
+bool Solver<BOX>::propagate(uint8_t* cells, Mask* domains)
+{
+    using S = Sudoku<BOX>;
+    ctx->aborted = false;
+    if (!load(cells) || !S::prepareSearch(*ctx))
+    {
+        return false;
+    }
+    const typename S::Board& board = ctx->board;
+    for (size_t cell = 0; cell < CELLS; ++cell)
+    {
+        //The propagation narrows domains without always placing their digit, so singles are read off them
+        Mask domain = board.cand[cell];
+        cells[cell] = board.cells[cell] != 0 ? board.cells[cell]
+                                             : S::countDigits(domain) == 1 ? S::lowestDigit(domain) : 0;
+        if (domains != nullptr)
+        {
+            domains[cell] = domain;
+        }
+    }
+    return true;
+}
+
+template <size_t BOX>
+bool Solver<BOX>::aborted() const
+{
+    return ctx->aborted;
+}
+
+template <size_t BOX>
+const SearchStats& Solver<BOX>::stats() const
+{
+    return ctx->stats;
+}
+
+template <size_t BOX>
+const LogicStats& Solver<BOX>::logic() const
+{
+    return ctx->logic;
+}
+
+template class Solver<2>;
+template class Solver<3>;
+template class Solver<4>;
+template class Solver<5>;
+
+namespace
+{
+
+/*
+State of the search for the canonical form of 1 puzzle, see SolutionCache::canonicalize
+grid is the puzzle, transposed or not, and the symmetry being tried takes its rows in the order rows
+and its columns in the order cols; best is the smallest form found so far, row by row
+*/
+struct CanonicalSearch
+{
+    static constexpr size_t BOX = 3;
+    static constexpr size_t SIZE = SolutionCache::SIZE;
+    static constexpr size_t CELLS = SolutionCache::CELLS;
+    uint8_t grid[CELLS];
+    //Number of clues in each row, column, band and stack of grid
+    uint8_t rowClues[SIZE];
+    uint8_t colClues[SIZE];
+    uint8_t bandClues[BOX];
+    uint8_t stackClues[BOX];
+    bool transpose;
+    uint8_t cols[SIZE];
+    uint8_t rows[SIZE];
+    //Relabeling of the digits after each number of rows, and the next label to hand out
+    uint8_t labels[SIZE + 1][SIZE + 1];
+    uint8_t nextLabel[SIZE + 1];
+    //The same after each number of cells of the first row
+    uint8_t firstLabels[SIZE + 1][SIZE + 1];
+    uint8_t firstNextLabel[SIZE + 1];
+    uint8_t best[CELLS];
+    SolutionCache::Symmetry* symmetry;
+    //Calls of searchRows and searchColumns so far, see CANONICAL_NODES
+    size_t nodes;
+};
+
+/*
+Most calls of searchRows and searchColumns spent on 1 puzzle
+Puzzles with many symmetries that tie, like a board with almost every cell filled, give up at this
+many instead of trying them all; they are not worth caching
+*/
+const size_t CANONICAL_NODES = 1 << 12;
+
+/*
+Returns true if line, a row or column of grid not placed yet, has the fewest clues of the lines of its band
+(or stack) not placed yet, and, if it starts a band, if its band has the fewest clues of the bands not used yet
+Empty lines and bands are all alike, so only the first one not placed yet is tried
+lineClues and bandClues count the clues of each line and band, and used is a mask of the lines already placed
+*/
+bool fewestClues(const uint8_t* lineClues, const uint8_t* bandClues, unsigned used, size_t line, bool startsBand)
+{
+    const size_t BOX = CanonicalSearch::BOX;
+    size_t band = line / BOX;
+    for (size_t other = band * BOX; other < band * BOX + BOX; ++other)
+    {
+        if ((used >> other & 1) == 0 && (lineClues[other] < lineClues[line] ||
+                                         (other < line && lineClues[other] == 0 && lineClues[line] == 0)))
+        {
+            return false;
+        }
+    }
+    for (size_t other = 0; startsBand && other < BOX; ++other)
+    {
+        if ((used >> (other * BOX) & 7) == 0 && (bandClues[other] < bandClues[band] ||
+                                                 (other < band && bandClues[other] == 0 && bandClues[band] == 0)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+Tries every order of the rows that keeps the bands together, from row level of the form on,
+with the order of the columns already chosen by searchColumns
+Rows are tried as long as the form is no bigger than best; a smaller row replaces the row of best
+and clears the rows after it, so best always holds the smallest form with the rows tried
+usedRows is a mask of the rows of grid already placed
+*/
+void searchRows(CanonicalSearch& search, size_t level, unsigned usedRows)
+{
+    const size_t BOX = CanonicalSearch::BOX;
+    const size_t SIZE = CanonicalSearch::SIZE;
+    if (++search.nodes > CANONICAL_NODES)
+    {
+        return;
+    }
+    if (level == SIZE)
+    {//A complete order no bigger than best, which is now the form it gives
+        SolutionCache::Symmetry& symmetry = *search.symmetry;
+        symmetry.transpose = search.transpose;
+        memcpy(symmetry.rows, search.rows, SIZE);
+        memcpy(symmetry.cols, search.cols, SIZE);
+        memcpy(symmetry.digits, search.labels[SIZE], SIZE + 1);
+        //Digits missing from the puzzle still need a label, so the solution can be relabeled back
+        uint8_t next = search.nextLabel[SIZE];
+        for (size_t d = 1; d <= SIZE; ++d)
+        {
+            if (symmetry.digits[d] == 0)
+            {
+                symmetry.digits[d] = next++;
+            }
+        }
+        return;
+    }
+    //The first row of a band can come from any band not used yet, the others from the band of the row before
+    size_t first = 0;
+    size_t last = SIZE;
+    if (level % BOX != 0)
+    {
+        first = search.rows[level - 1] / BOX * BOX;
+        last = first + BOX;
+    }
+    uint8_t* bestRow = search.best + level * SIZE;
+    for (size_t r = first; r < last; ++r)
+    {
+        if ((usedRows >> r & 1) != 0 || (level % BOX == 0 && (usedRows >> (r / BOX * BOX) & 7) != 0) ||
+            !fewestClues(search.rowClues, search.bandClues, usedRows, r, level % BOX == 0))
+        {
+            continue;
+        }
+        uint8_t* labels = search.labels[level + 1];
+        memcpy(labels, search.labels[level], SIZE + 1);
+        uint8_t next = search.nextLabel[level];
+        uint8_t row[SIZE];
+        //Stop at the first cell bigger than best, unless a cell before it was already smaller
+        bool smaller = false;
+        size_t j = 0;
+        for (; j < SIZE; ++j)
+        {
+            uint8_t digit = search.grid[r * SIZE + search.cols[j]];
+            if (digit != 0 && labels[digit] == 0)
+            {
+                labels[digit] = next++;
+            }
+            row[j] = labels[digit];
+            if (!smaller && row[j] != bestRow[j])
+            {
+                if (row[j] > bestRow[j])
+                {
+                    break;
+                }
+                smaller = true;
+            }
+        }
+        if (j < SIZE)
+        {
+            continue;
+        }
+        if (smaller)
+        {
+            memcpy(bestRow, row, SIZE);
+            memset(bestRow + SIZE, 0xFF, (SIZE - 1 - level) * SIZE);
+        }
+        search.nextLabel[level + 1] = next;
+        search.rows[level] = static_cast<uint8_t>(r);
+        searchRows(search, level + 1, usedRows | 1u << r);
+    }
+}
+
+/*
+Tries every order of the columns that keeps the stacks together, from column level of the form on,
+with the first row of the form taken from row rows[0] of grid
+Like searchRows, but cell by cell, so orders that make the first row too big are dropped early
+Each complete order of the columns goes on to searchRows for the other rows
+usedCols is a mask of the columns of grid already placed
+*/
+void searchColumns(CanonicalSearch& search, size_t level, unsigned usedCols)
+{
+    const size_t BOX = CanonicalSearch::BOX;
+    const size_t SIZE = CanonicalSearch::SIZE;
+    if (++search.nodes > CANONICAL_NODES)
+    {
+        return;
+    }
+    if (level == SIZE)
+    {
+        memcpy(search.labels[1], search.firstLabels[SIZE], SIZE + 1);
+        search.nextLabel[1] = search.firstNextLabel[SIZE];
+        searchRows(search, 1, 1u << search.rows[0]);
+        return;
+    }
+    //The first column of a stack can come from any stack not used yet, the others from the stack of the column before
+    size_t first = 0;
+    size_t last = SIZE;
+    if (level % BOX != 0)
+    {
+        first = search.cols[level - 1] / BOX * BOX;
+        last = first + BOX;
+    }
+    const uint8_t* gridRow = search.grid + search.rows[0] * SIZE;
+    for (size_t c = first; c < last; ++c)
+    {
+        if ((usedCols >> c & 1) != 0 || (level % BOX == 0 && (usedCols >> (c / BOX * BOX) & 7) != 0) ||
+            !fewestClues(search.colClues, search.stackClues, usedCols, c, level % BOX == 0))
+        {
+            continue;
+        }
+        uint8_t* labels = search.firstLabels[level + 1];
+        memcpy(labels, search.firstLabels[level], SIZE + 1);
+        uint8_t next = search.firstNextLabel[level];
+        uint8_t digit = gridRow[c];
+        if (digit != 0 && labels[digit] == 0)
+        {
+            labels[digit] = next++;
+        }
+        uint8_t value = labels[digit];
+        if (value > search.best[level])
+        {
+            continue;
+        }
+        if (value < search.best[level])
+        {
+            search.best[level] = value;
+            memset(search.best + level + 1, 0xFF, CanonicalSearch::CELLS - 1 - level);
+        }
+        search.firstNextLabel[level + 1] = next;
+        search.cols[level] = static_cast<uint8_t>(c);
+        searchColumns(search, level + 1, usedCols | 1u << c);
+    }
+}
+
+}
+
+SolutionCache::SolutionCache(size_t capacity)
+    : capacity(capacity)
+{
+}
+
+/*
+Every row of the puzzle and of its transpose that can come first is tried as the first row of the form,
+then the columns are ordered with searchColumns and the other rows with searchRows
+Only orders that list the lines by their number of clues are tried, see fewestClues, which leaves few ties,
+and a cell or row bigger than the same one of the smallest form found so far ends the search down that path,
+so most of the symmetries are never looked at in full
+*/
+bool SolutionCache::canonicalize(const uint8_t* cells, CanonicalForm& form)
+{
+    const size_t BOX = CanonicalSearch::BOX;
+    CanonicalSearch search;
+    memset(search.best, 0xFF, CELLS);
+    memset(search.firstLabels[0], 0, SIZE + 1);
+    search.firstNextLabel[0] = 1;
+    search.symmetry = &form.symmetry;
+    search.nodes = 0;
+    for (size_t t = 0; t < 2; ++t)
+    {
+        search.transpose = t != 0;
+        for (size_t r = 0; r < SIZE; ++r)
+        {
+            for (size_t c = 0; c < SIZE; ++c)
+            {
+                search.grid[r * SIZE + c] = search.transpose ? cells[c * SIZE + r] : cells[r * SIZE + c];
+            }
+        }
+        memset(search.rowClues, 0, SIZE);
+        memset(search.colClues, 0, SIZE);
+        memset(search.bandClues, 0, BOX);
+        memset(search.stackClues, 0, BOX);
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            uint8_t clue = search.grid[cell] != 0;
+            search.rowClues[cell / SIZE] += clue;
+            search.colClues[cell % SIZE] += clue;
+            search.bandClues[cell / SIZE / BOX] += clue;
+            search.stackClues[cell % SIZE / BOX] += clue;
+        }
+        for (size_t r = 0; r < SIZE; ++r)
+        {
+            if (fewestClues(search.rowClues, search.bandClues, 0, r, true))
+            {
+                search.rows[0] = static_cast<uint8_t>(r);
+                searchColumns(search, 0, 0);
+            }
+        }
+    }
+    memcpy(form.cells, search.best, CELLS);
+    return search.nodes <= CANONICAL_NODES;
+}
+
+bool SolutionCache::find(const CanonicalForm& form, uint8_t* cells, bool& solved)
+{
+    string solution;
+    {
+        lock_guard<mutex> guard(lock);
+        auto entry = entries.find(string_view(reinterpret_cast<const char*>(form.cells), CELLS));
+        if (entry == entries.end())
+        {
+            return false;
+        }
+        recent.splice(recent.begin(), recent, entry->second);
+        solution = entry->second->solution;
+    }
+    solved = !solution.empty();
+    if (solved)
+    {//Undo the symmetry: canonical cell (i, j) came from row rows[i] and column cols[j]
+        const Symmetry& symmetry = form.symmetry;
+        uint8_t original[SIZE + 1];
+        for (size_t d = 0; d <= SIZE; ++d)
+        {
+            original[symmetry.digits[d]] = static_cast<uint8_t>(d);
+        }
+        for (size_t i = 0; i < SIZE; ++i)
+        {
+            for (size_t j = 0; j < SIZE; ++j)
+            {
+                size_t r = symmetry.rows[i];
+                size_t c = symmetry.cols[j];
+                size_t cell = symmetry.transpose ? c * SIZE + r : r * SIZE + c;
+                cells[cell] = original[static_cast<uint8_t>(solution[i * SIZE + j])];
+            }
+        }
+    }
+    return true;
+}
+
+void SolutionCache::insert(const CanonicalForm& form, const uint8_t* solution)
+{
+    string canonical;
+    if (solution != nullptr)
+    {//Apply the symmetry to the solution, as it was to the puzzle
+        const Symmetry& symmetry = form.symmetry;
+        canonical.resize(CELLS);
+        for (size_t i = 0; i < SIZE; ++i)
+        {
+            for (size_t j = 0; j < SIZE; ++j)
+            {
+                size_t r = symmetry.rows[i];
+                size_t c = symmetry.cols[j];
+                size_t cell = symmetry.transpose ? c * SIZE + r : r * SIZE + c;
+                canonical[i * SIZE + j] = static_cast<char>(symmetry.digits[solution[cell]]);
+            }
+        }
+    }
+    lock_guard<mutex> guard(lock);
+    add(string(reinterpret_cast<const char*>(form.cells), CELLS), move(canonical));
+}
+
+void SolutionCache::add(string puzzle, string solution)
+{
+    auto entry = entries.find(puzzle);
+    if (entry != entries.end())
+    {//Another thread solved the same puzzle first
+        recent.splice(recent.begin(), recent, entry->second);
+        return;
+    }
+    recent.push_front(Entry{move(puzzle), move(solution)});
+    entries.emplace(recent.front().puzzle, recent.begin());
+    if (capacity != 0 && recent.size() > capacity)
+    {
+        entries.erase(recent.back().puzzle);
+        recent.pop_back();
+    }
+}
+
+bool SolutionCache::load(const string& path)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    //A canonical puzzle, a space, its solution or -, and the line ending
+    char line[2 * CELLS + 4];
+    bool valid = true;
+    lock_guard<mutex> guard(lock);
+    while (valid && fgets(line, sizeof(line), file) != nullptr)
+    {
+        size_t length = strcspn(line, "\r\n");
+        bool solved = length == 2 * CELLS + 1;
+        valid = (solved || (length == CELLS + 2 && line[CELLS + 1] == '-')) && line[CELLS] == ' ';
+        string puzzle(CELLS, 0);
+        string solution(solved ? CELLS : 0, 0);
+        for (size_t cell = 0; valid && cell < CELLS; ++cell)
+        {
+            puzzle[cell] = static_cast<char>(line[cell] - '0');
+            valid = line[cell] >= '0' && line[cell] <= '9';
+            if (solved)
+            {
+                solution[cell] = static_cast<char>(line[CELLS + 1 + cell] - '0');
+                valid = valid && line[CELLS + 1 + cell] >= '1' && line[CELLS + 1 + cell] <= '9';
+            }
+        }
+        if (valid)
+        {
+            add(move(puzzle), move(solution));
+        }
+    }
+    fclose(file);
+    return valid;
+}
+
+bool SolutionCache::save(const string& path) const
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    char line[2 * CELLS + 2];
+    bool written = true;
+    lock_guard<mutex> guard(lock);
+    for (auto entry = recent.rbegin(); entry != recent.rend(); ++entry)
+    {
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            line[cell] = static_cast<char>('0' + entry->puzzle[cell]);
+        }
+        line[CELLS] = ' ';
+        size_t length = CELLS + 1;
+        if (entry->solution.empty())
+        {
+            line[length++] = '-';
+        }
+        else
+        {
+            for (size_t cell = 0; cell < CELLS; ++cell)
+            {
+                line[length++] = static_cast<char>('0' + entry->solution[cell]);
+            }
+        }
+        line[length++] = '\n';
+        written = written && fwrite(line, 1, length, file) == length;
+    }
+    return fclose(file) == 0 && written;
+}
+
+size_t SolutionCache::size() const
+{
+    lock_guard<mutex> guard(lock);
+    return entries.size();
+}
+
+}
@@ -1,745 +1,2294 @@
-/*
-Sudoku Solver Using AI
-*/
-
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <algorithm> //For heap construction
-#include <string>
-#include <utility> //For pair
-#include <unordered_map>
-#include <stdlib.h>//For rand
-#include <time.h>
-#include <unordered_set>
-
-using namespace std;
-
-/*
-Prints the numbers in the board, as a 2d representation
-Input: the 9x9 board
-*/
-void printBoard(const vector<vector<string>>& board)
-{
-    for (const auto& i : board)
-    {
-        for (const string& j : i)
-        {
-            cout << j << " ";
-        }
-        cout << '\n';
-    }
-}
-
-/*
-Prints the numbers in the domain, as a 2d representation
-Input: the 9x9 domain
-*/
-void printDom(const vector<vector< vector<string> >>& domain)
-{
-    cout << "Domain size: " << domain.size() << '\n';
-    for (const auto& x : domain)
-    {
-        //cout << x.size() << "\n";
-        for (const auto& y : x)
-        {
-            cout << "Going Through individual domain - Size: " << y.size() << " -> ";
-            for (const auto& z : y)
-            //for (int i = 0; i < y.size(); ++i)
-            {
-                //cout << y[i] << " ";
-                cout << z << " ";
-            }
-            cout << '\n';
-        }
-        cout << '\n';
-    }
-    return ;
-}
-
-/*
-Fills out the initial legal values for the domain of 1 variable
-0 has 1-9
-Else the domain is specified to the number that's already there
-*/
-void constructDomVar(const string& var, vector<string>& domain)
-{
-    //cout << "In constructDomVar -> ";
-    if (var == "0")
-    {
-        //cout << "No domain specified!\n";
-        for (int i = 1; i < 10; ++i)
-        {
-            domain.emplace_back(to_string(i));
-            //push_heap(domain.begin(), domain.end());
-        }
-    }
-    else
-    {
-        //cout << "Domain Specified!\n";
-        //Should only be 1 thing in the heap, and so does not need to be sorted
-        domain.emplace_back(var);
-        //push_heap(domain.begin(), domain.end());
-    }
-    make_heap(domain.begin(), domain.end(), greater<string>());
-}
-
-/*
-Fills out the initial legal values for the domain of the 9x9 variables
-0 has 1-9
-Else the domain is specified to the number that's already there
-*/
-void constructDom(const vector<vector<string>>& board, vector<vector< vector<string> >>& domain)
-{
-    for (size_t i = 0; i < 9; ++i)
-    {
-        for (size_t j = 0; j < 9; ++j)
-        {
-            //cout << "i,j: " << i << " " << j << "\n";
-            //cout << "board: " << (board[i][j]) << "\ndomain:\n";
-            //cout << domain[i][j] << "\n";
-            constructDomVar(board[i][j], domain[i][j]);
-        }
-    }
-}
-
-/*
-Checks to see if complete assignment of board
-Input: the 9x9 board
-*/
-bool isCompleteBoard(const vector<vector<string>>& board)
-{
-    for (const auto& i : board)
-    {
-        for (const string& j : i)
-        {
-            if (j == "0")
-            {
-                return false;
-            }
-        }
-    }
-    return true;
-}
-
-/*
-For inserting into the map
-with data type below
-This maps is used to map multiple values to 1 key
-These multiple values can then be retrieved with [] or at()
-Unlike using regular maps or multimaps
-*/
-void insertToMap(unordered_map<size_t, vector< pair<size_t, size_t> > >& unOrdMap, size_t key, size_t i, size_t j)
-{
-    vector< pair<size_t, size_t> > temp;
-    if (unOrdMap.find(key) == unOrdMap.end())
-    {//Then key has not been already inserted; 1st time inserting key
-        temp.emplace_back(i, j);
-        unOrdMap.emplace(key, temp);
-    }
-    else
-    {//Add the current location to the end of the vector and rewrite the map
-        temp = unOrdMap.at(key);
-        temp.emplace_back(i, j);
-        unOrdMap.at(key) = temp;
-    }
-}
-
-/*
-Implements Minimum Remaining Value Heuristic for Sudoku
-Inputs:
-The current domain
-The minimum amount of remaining values found in the domain
-A map mapping remaining values to coordinates
-Output:
-True if single coordinate mapped to mrv
-False otherwise
-If false, proceed to degree heuristic
-
-Note 1: Clears current value of min for new value
-
-Note 2: Did not use unordered_multimap because, upon viewing the API,
-find still only returns 1 element only
-*/
-bool mrv(const vector<vector< vector<string> >>& domain, size_t& min,
-         unordered_map<size_t, vector< pair<size_t, size_t> > >& remainingVals)
-{
-    //Temp Count of the min number of legal val in a var
-    //min = domain[0][0].size();
-
-    //If everything only has 1 legal value left, then it should be a complete assignment,
-    //which has already been checked for before calling mrv
-    //There can only be nine legal values max; 1-9
-    min = 10;
-    //Loop through the domain
-    for (size_t i = 0; i < 9; ++i)
-    {
-        for (size_t j = 0; j < 9; ++j)
-        {
-            //cerr << "i,j -> " << i << ", " << j << '\n';
-            //Add the remaining value to the map
-            size_t key = domain[i][j].size();
-            insertToMap(remainingVals, key, i, j);
-
-            //Update min if there is a variable with less remaining values
-            //Only for keeping track of first singular coordinate of mrv
-            if ((domain[i][j].size() > 1) && (domain[i][j].size() < min))
-            {
-                //Updated min
-                //cout << "Updated MRV min\n";
-                min = key;
-            }
-        }
-    }
-    /*
-    cout << "End MRV looping through domain\n";
-    cout << "MRV Results: Min -> " << min << " Count -> " << remainingVals.at(min).size() << "\n";
-    for (const auto& x : remainingVals.at(min))
-    {
-        cout << x.first << ", " << x.second << "\n";
-    }
-    cout << '\n';
-    */
-    if (remainingVals.at(min).size() != 1)
-    {//If more than 1 possible var, return false and use degree heuristic
-        return false;
-    }
-    //cout << "MRV Results: Min -> " << min << "; a, b -> " << a << ", " << b << '\n';
-    //There is only 1 possible var
-    return true;
-}
-
-/*
-Returns the updated number of unassigned neighbors there are for the specified coordinate
-i,j are the original coordinates
-a,b are the coordinates you are checking to see if it is unassigned
-*/
-void updateConstraintCount(const vector<vector<string>>& board, const size_t i, const size_t j,
-    const size_t a, const size_t b, unordered_set<size_t>& visited, size_t& count)
-{
-    size_t key = a * 10 + b;
-    if (visited.find(key) != visited.end())
-    {//If you haven't seen this coordinate before
-        if ((board[a][b] == "0") && (a != i) && (b != j))
-        {//If that coordinate is unassigned and it isn't the original coordinate, ++count
-            ++count;
-        }
-        visited.emplace(key);
-    }
-    //Else you have seen it before, and so you don't double count
-}
-
-/*
-Returns the count of how many unassigned neighbors there are for the row of i,j
-Visited is used to prevent double counting neighbors
-*/
-size_t countRowConstraint(const vector<vector<string>>& board, const size_t i, const size_t j, unordered_set<size_t>& visited)
-{
-    size_t count = 0;
-    for (size_t a = 0; a < 9; ++a)
-    {
-        updateConstraintCount(board, i, j, i, a, visited, count);
-    }
-    return count;
-}
-
-/*
-Returns the count of how many unassigned neighbors there are for the column of i,j
-Visited is used to prevent double counting neighbors
-*/
-size_t countColConstraint(const vector<vector<string>>& board, const size_t i, const size_t j, unordered_set<size_t>& visited)
-{
-    size_t count = 0;
-    for (size_t a = 0; a < 9; ++a)
-    {
-        updateConstraintCount(board, i, j, a, j, visited, count);
-    }
-    return count;
-}
-
-/*
-Helper function for countGridConstraint
-Does the actual counting in a grid
-r0, r1 are used for row bounds
-c0, c1 are used for col bounds
-i,j are the original coordinates
-*/
-size_t countGridHelp(const vector<vector<string>>& board, const size_t r0, const size_t r1,
-    const size_t c0, const size_t c1, const size_t i, const size_t j, unordered_set<size_t>& visited)
-{
-    size_t count = 0;
-    //x,y used to navigate
-    for (size_t x = r0; x <= r1; ++x)
-    {
-        for (size_t y = c0; y <= c1; ++y)
-        {
-            updateConstraintCount(board, i, j, x, y, visited, count);
-        }
-    }
-    return count;
-}
-
-/*
-Returns the count of how many unassigned neighbors there are for the 3x3 grid of i,j
-Visited is used to prevent double counting neighbors
-*/
-size_t countGridConstraint(const vector<vector<string>>& board, const size_t i, const size_t j, unordered_set<size_t>& visited)
-{
-    size_t count = 0;
-    //BE CAREFUL NOT TO DOUBLE COUNT, SINCE ROW AND COL COUNTS ARE DONE BEFOREHAND
-
-    if (i <= 2)
-    {//Within rows 0-2
-        if (j <= 2)
-        {//Within cols 0-2
-            count += countGridHelp(board, 0, 2, 0, 2, i, j, visited);
-        }
-        else if (j >= 6)
-        {//Within cols 6-8
-            count += countGridHelp(board, 0, 2, 6, 8, i, j, visited);
-        }
-        else
-        {//Within cols 3-5
-            count += countGridHelp(board, 0, 2, 3, 5, i, j, visited);
-        }
-    }
-    else if (i >= 6)
-    {//Within rows 6-8
-        if (j <= 2)
-        {//Within cols 0-2
-            count += countGridHelp(board, 6, 8, 0, 2, i, j, visited);
-        }
-        else if (j >= 6)
-        {//Within cols 6-8
-            count += countGridHelp(board, 6, 8, 6, 8, i, j, visited);
-        }
-        else
-        {//Within cols 3-5
-            count += countGridHelp(board, 6, 8, 3, 5, i, j, visited);
-        }
-    }
-    else
-    {//Within rows 5-7
-        if (j <= 2)
-        {//Within cols 0-2
-            count += countGridHelp(board, 5, 7, 0, 2, i, j, visited);
-        }
-        else if (j >= 6)
-        {//Within cols 6-8
-            count += countGridHelp(board, 5, 7, 6, 8, i, j, visited);
-        }
-        else
-        {//Within cols 3-5
-            count += countGridHelp(board, 5, 7, 3, 5, i, j, visited);
-        }
-    }
-    return count;
-}
-
-/*
-Implements degree heuristic for Sudoku
-*/
-pair<int, int> deg(const vector<vector<string>>& board,
-    const vector< pair<size_t, size_t> >& remainingVars)
-{
-    //Keep track of how many unassigned neighbors the remaining variables have
-    unordered_map<size_t, vector< pair<size_t, size_t> > > numNeighborsToVar;
-    size_t maxUnassignedNeighbors = 0;
-    //Loop through the remaining variables
-    for (const auto& x : remainingVars)
-    {
-        //Calculate the number of unassigned neighbors
-        //This is the key to the map
-        size_t numUnNeighbors = 0;
-        unordered_set<size_t> visited;
-        numUnNeighbors += countRowConstraint(board, x.first, x.second, visited);
-        numUnNeighbors += countColConstraint(board, x.first, x.second, visited);
-        numUnNeighbors += countGridConstraint(board, x.first, x.second, visited);
-        //Add the remaining value to the map
-        insertToMap(numNeighborsToVar, numUnNeighbors, x.first, x.second);
-        //cout << "numUnNeighbors: " << numUnNeighbors << '\n';
-
-        //Update max if there is a variable with more unassigned neighbors
-        if (numUnNeighbors >= maxUnassignedNeighbors)
-        {
-            maxUnassignedNeighbors = numUnNeighbors;
-        }
-    }
-    //cout << "End loop\n";
-    if (numNeighborsToVar.at(maxUnassignedNeighbors).size() == 1)
-    {//If only 1 possible var, return it
-        //cout << "1\n";
-        return pair<size_t, size_t>(numNeighborsToVar.at(maxUnassignedNeighbors)[0]);
-    }
-    //cout << ">1\n";
-    //Else, randomly choose among the vars with same maxUnassignedNeighbors
-    srand(time(nullptr));
-    //cout << "After srand()\n";
-    size_t n = rand() % numNeighborsToVar.at(maxUnassignedNeighbors).size();
-    //cout << "rand() size(): " << numNeighborsToVar.at(maxUnassignedNeighbors).size() << " n: " << n << '\n';
-    return numNeighborsToVar.at(maxUnassignedNeighbors)[n];
-}
-
-/*
-Returns a selected unassigned variable to branch off by setting values later on
-*/
-pair<int, int> selectUnassignedVar(const vector<vector<string>>& board, const vector<vector< vector<string> >>& domain)
-{
-    //Run Minimum Remaining Value Heuristic
-    size_t min = 69;//Max only 9 vals left, 1-9
-    unordered_map<size_t, vector< pair<size_t, size_t> > > remainingVals;
-    if (mrv(domain, min, remainingVals))
-    {
-        return remainingVals.at(min)[0];
-    }
-    //cout << "Running degree heuristic in selectUnassignedVar\n";
-    //cout << "min: " << min << '\n';
-    //If mrv fails, then run degree heuristic
-    return deg(board, remainingVals.at(min));
-}
-
-/*
-Helper function for checking consistency
-Loops over used
-If a number is used more than once, then it returns false
-Otherwise, it is locally consistent and returns true
-0 can be used more than once, since it indicates there is no value assigned there
-*/
-bool tallyUsed(const vector<int>& used)
-{
-    bool result = true;
-    /*
-    cout << "  Printing USED vector\n";
-
-    for (const auto x : used)
-    {
-        cout << x << " ";
-    }
-    cout << '\n';
-    */
-    for (size_t i = 1; i < 10; ++i)
-    {
-        int x = used[i];
-        if ((x != 1) && (x != 0))
-        {//If this int is used more than once, we need to return false
-            //cout << "\t!!! Inconsistency found: " << x << " !!! \n";
-            result = (result && false);
-        }
-    }
-    //cout << "Result from tallyUsed: " << result << '\n';
-    return result;
-}
-
-/*
-Checks to see if all rows of an assignment of the board is consistent
-Returns true if it is consistent
-False if not consistent
-*/
-bool checkConsistentRows(const vector<vector<string>>& board)
-{
-    //cout << "CHECKING CONSISTENT ROWS\n----------------\n";
-    bool result = true;
-    for (size_t i = 0; i < 9; ++i)
-    {
-        //The index is a number
-        //[] returns how many times the number has been used in the row
-        vector<int> used(10, 0);
-        //cout << " Used --- Row: " << i;
-        for (size_t j = 0; j < 9; ++j)
-        {
-            //cout << " Column: " << j << " ";
-            //cout << stoi(board[i][j]) << "\n";
-            ++used[stoi(board[i][j])];
-        }
-        result = result && tallyUsed(used);
-        if (!result)
-        {//If result is false in this row, return false immediately
-            return result;
-        }
-    }
-    return result;
-}
-
-/*
-Checks to see if all columns of an assignment of the board is consistent
-Returns true if it is consistent
-False if not consistent
-*/
-bool checkConsistentCols(const vector<vector<string>>& board)
-{
-    //cout << "CHECKING CONSISTENT COLS\n----------------\n";
-    bool result = true;
-    for (size_t j = 0; j < 9; ++j)
-    {
-        //The index is a number
-        //[] returns how many times the number has been used in the col
-        vector<int> used(10, 0);
-        for (size_t i = 0; i < 9; ++i)
-        {
-            ++used[stoi(board[i][j])];
-        }
-        result = result && tallyUsed(used);
-        if (!result)
-        {//If result is false in this col, return false immediately
-            return result;
-        }
-    }
-    return result;
-}
-
-/*
-Helper function for checkConsistentGrids
-Does the actual checking in a grid
-r0, r1 are used for row bounds
-c0, c1 are used for col bounds
-Returns true if local grid constraint met
-False if inconsistent
-*/
-bool checkConsistentGridsHelp(const vector<vector<string>>& board,
-    const size_t r0, const size_t r1, const size_t c0, const size_t c1)
-{
-    bool result = true;
-    //The index is a number
-    //[] returns how many times the number has been used in the col
-    vector<int> used(10, 0);
-    //x,y used to navigate
-    //cout << "Checking Consistent Grid: " << r0 << ", " << r1 << " " << c0 << " " << c1 << '\n';
-    for (size_t x = r0; x <= r1; ++x)
-    {
-        for (size_t y = c0; y <= c1; ++y)
-        {//Update the frequency of the number being used
-            //cout << "Updating Freq " << x << " " << y << " of " << stoi(board[x][y]) << '\n';
-            //cout << "\tCurrent Freq BEFORE Update: " << used[stoi(board[x][y])];
-            used[stoi(board[x][y])] = 1 + used[stoi(board[x][y])];
-            /*
-            cout << " Freq After update: " << used[stoi(board[x][y])] << '\n';
-            cout << "\t\tPrinting USED vector IN LOOP of test\n\t\t";
-            for (const auto x : used)
-            {
-                cout << x << " ";
-            }
-            cout << '\n';
-            */
-        }
-    }
-    /*
-    cout << "Printing USED vector IN TEST\n";
-    for (const auto x : used)
-    {
-        cout << x << " ";
-    }
-    cout << '\n';
-    */
-    result = result && tallyUsed(used);
-    return result;
-}
-
-/*
-Checks to see if all nine 3x3 grids of an assignment of the board is consistent
-Returns true if it is consistent
-False if not consistent
-*/
-bool checkConsistentGrids(const vector<vector<string>>& board)
-{
-    //cout << "CHECKING CONSISTENT GRIDS\n----------------\n";
-
-    return checkConsistentGridsHelp(board, 0, 2, 0, 2) && checkConsistentGridsHelp(board, 0, 2, 3, 5) &&
-    checkConsistentGridsHelp(board, 0, 2, 6, 8) && checkConsistentGridsHelp(board, 3, 5, 0, 2) &&
-    checkConsistentGridsHelp(board, 3, 5, 3, 5) && checkConsistentGridsHelp(board, 3, 5, 6, 8) &&
-    checkConsistentGridsHelp(board, 6, 8, 0, 2) && checkConsistentGridsHelp(board, 6, 8, 3, 5) &&
-    checkConsistentGridsHelp(board, 6, 8, 6, 8);
-
-    /*
-    vector<vector<string>> testX{vector<string>{"94","4","9","5","95","96","97","98","99"},
-                                vector<string>{"90","2","8","9","14","15","16","17","18"},
-                                vector<string>{"70","1","3","7","23","24","25","26","27"}};
-    cout << "In test checkGrids\n";
-    return checkConsistentGridsHelp(testX, 0, 2, 1, 3);
-    */
-}
-
-/*
-Checks to see if an assignment of the board is consistent
-Returns true if it is consistent
-False if not consistent
-*/
-bool isConsistent(const vector<vector<string>>& board)
-{
-    //cout << "\nRUNNING ISCONSISTENT()!!!!!!!!!\n-------------\n";
-    //cout << "\tconsistentRows: " << boolalpha << checkConsistentRows(board);
-    //cout << "\tconsistentCols: " << boolalpha << checkConsistentCols(board);
-    bool temp = checkConsistentGrids(board);
-    //cout << "\tconsistentGrids: " << boolalpha << temp << '\n';
-    //cout << '\n';
-    //cout << "Running and Returning isConsistent()";
-    //return false;
-    return checkConsistentRows(board) && checkConsistentCols(board) && temp;
-}
-
-/*
-Does the actual backtracking algorithm for the Sudoku board
-*/
-bool backtrack(vector<vector<string>>& board, vector<vector< vector<string> >>& domain)
-{
-    if (isCompleteBoard(board))
-    {
-        //cout << "Complete Board Assignment!!";
-        return true;
-    }
-    //Indices to traverse the board
-    //cout << "Selecting Var\n";
-    pair<size_t, size_t> var = selectUnassignedVar(board, domain);
-    size_t i = var.first;
-    size_t j = var.second;
-    //cout << "Backtracking on i, j: " << i << ", " << j << " Domain size: " << domain[i][j].size() << "\n";
-    //cout << "Domain values:\n";
-    /*
-    for (const auto& x : domain[i][j])
-    {
-        cout << x << " ";
-    }
-    cout << '\n';
-    */
-    //Values in the domain are sorted in increasing order, due to heap properties
-    for (auto& value : domain[i][j])
-    {
-        vector<vector<string>> newBoard = board;
-        newBoard[i][j] = value;
-        //cout << "\tChecking isConsistent( " << value << " ): " << boolalpha << isConsistent(newBoard) << '\n';
-        if (isConsistent(newBoard))
-        {//If value is consistent with assignment
-            //Update the board with new value
-            board[i][j] = value;
-            //Update the domain with new value
-            auto save = domain[i][j];
-            vector<string> tempVal;
-            tempVal.emplace_back(value);
-            domain[i][j] = tempVal;
-            //Recurse
-            bool result = backtrack(board, domain);
-            if (result)
-            {//If the recursive call is successful, we also return true
-                return true;
-            }
-            //Else, this branch is dead, do not use this value
-            board[i][j] = "0";
-            domain[i][j] = save;
-        }
-    }
-    return false;
-}
-
-int main()
-{
-    //Set up the 9x9 board
-    vector<vector<string>> board(9);
-    for (auto& i : board)
-    {
-        for (int a = 0; a < 9; ++a)
-        {
-            i.push_back("0");
-        }
-    }
-    //printBoard(board);
-
-    //cout << "Opening input\n";
-    /*
-    Read the board state from the input file
-    */
-    ifstream ifs;
-    ifs.open("Input1.txt");
-    //ifs.open("int.txt");
-    if (!ifs)
-    {
-        cerr << "Could not open input file\n";
-        exit(1);
-    }
-    string line{};
-    size_t i = 0;
-    size_t j = 0;
-    while (ifs >> line)
-    {
-        if (i == 8 && j == 9)
-        {
-            cerr << "Error: board overflow\n";
-            exit(2);
-        }
-        board[i][j] = line;
-        //cout << i << " " << j << "  ";
-        ++j;
-        if (j == 9)
-        {
-            j = 0;
-            ++i;
-            //cout << "endline \n";
-        }
-    }
-    cout << "Finished Board Setup\n";
-    //printBoard(board);
-    ifs.close();
-    ifs.clear();
-
-    //cout << "\nConstructing Domain\n";
-    //Construct 9x9 grid of domain of each variable
-    //vector<vector<priority_queue<greater<string>, vector<string>>>> domain(9);
-    vector<vector< vector<string> >> domain(9);
-    for (auto& x : domain)
-    {
-        for (int a = 0; a < 9; ++a)
-        {
-            x.push_back({});
-        }
-    }
-    //constructDomVar(board[0][0], domain[0][0]);
-
-    //cout << "Domain Before Construct\n";
-    //printDom(domain);
-
-    cout << "Domain After Construct\n";
-    constructDom(board, domain);
-    //printDom(domain);
-
-    /*
-    cout << "Testing MRV: \n";
-    size_t minTemp;
-    unordered_map<size_t, vector< pair<size_t, size_t> > > remTemp;
-    bool mrvTest = mrv(domain, minTemp, remTemp);
-    //cout << mrvTest.first << ", " << mrvTest.second << '\n';
-    cout << boolalpha << mrvTest << '\n';
-    */
-
-    cout << "Testing Degree\n";
-    //cout << "CountColConstraint 0,2: " << countColConstraint(board, 0, 2);
-
-    //Use backtracking to solve Sudoku puzzle
-    cout << "\nBacktracking\n";
-    cout << "Result: " << std::boolalpha << backtrack(board, domain) << '\n';
-    //cout << "TEST!! " << checkConsistentGrids(board) << '\n';
-    printBoard(board);
-    //printDom(domain);
-
-    //Output results to an output file
-    ofstream ofs("Output1.txt");
-    if (!ofs)
-    {
-        cerr << "Could not open output file\n";
-        exit(3);
-    }
-    line = "";
-    for (const auto& i : board)
-    {
-        for (const string& j : i)
-        {
-            line += j;
-            line += " ";
-        }
-        //If more than 1 tile, remove the ending space of the line
-        line = line.substr(0, 17);
-        line += "\n";
-        //Add the line to output file and then clear line
-        ofs << line;
-        line = "";
-    }
-    ofs.close();
-
-}
+/*
+Sudoku Solver Using AI
+*/
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <chrono>//For the default seed
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <numeric>//For iota
+#include <memory>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>//For the server
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "sudoku.h"
+
+using namespace std;
+using namespace sudoku;
+
+/*
+Prints how many times each logic rule made progress
+*/
+void printLogicStats(const LogicStats& logic)
+{
+    cout << "Logic rules fired:\n";
+    cout << "  Naked singles: " << logic.nakedSingles << '\n';
+    cout << "  Hidden singles: " << logic.hiddenSingles << '\n';
+    cout << "  Naked pairs: " << logic.nakedPairs << '\n';
+    cout << "  Naked triples: " << logic.nakedTriples << '\n';
+    cout << "  Hidden pairs: " << logic.hiddenPairs << '\n';
+    cout << "  Hidden triples: " << logic.hiddenTriples << '\n';
+    cout << "  Pointing: " << logic.pointing << '\n';
+    cout << "  Box-line reduction: " << logic.boxLine << '\n';
+}
+
+/*
+Prints the numbers in the board, as a 2d representation
+Input: the board
+*/
+template <size_t BOX>
+void printBoard(const typename Sudoku<BOX>::Board& board)
+{
+    const size_t SIZE = Sudoku<BOX>::SIZE;
+    for (size_t i = 0; i < SIZE; ++i)
+    {
+        for (size_t j = 0; j < SIZE; ++j)
+        {
+            cout << static_cast<int>(board.cells[i * SIZE + j]) << " ";
+        }
+        cout << '\n';
+    }
+}
+
+/*
+Range of jobs owned by one worker of a WorkerPool
+Jobs are claimed by incrementing next, so the owner and other workers stealing
+from the range never take the same job, and no lock is needed
+*/
+struct alignas(64) WorkRange
+{
+    atomic<size_t> next{0};
+    size_t end = 0;
+};
+
+/*
+Pool of threads that run a task over a number of jobs, see runJobs
+Each worker starts on its own range of jobs and steals from the others once it runs out,
+so the jobs stay spread over the workers even when some take much longer than others
+The thread calling runJobs takes part as the last worker
+*/
+struct WorkerPool
+{
+    size_t workers = 1;
+    vector<thread> threads;
+    unique_ptr<WorkRange[]> ranges;
+    mutex lock;
+    condition_variable wake;
+    condition_variable finished;
+    //Incremented for every call of runJobs, so the threads know there is new work
+    size_t generation = 0;
+    size_t busy = 0;
+    bool stopping = false;
+    const function<void(size_t, size_t)>* task = nullptr;
+};
+
+/*
+Runs the task on jobs until every range of the pool is empty
+worker is the index of the calling worker, whose own range is emptied first
+*/
+void drainJobs(WorkerPool& pool, size_t worker)
+{
+    for (size_t offset = 0; offset < pool.workers; ++offset)
+    {
+        WorkRange& range = pool.ranges[(worker + offset) % pool.workers];
+        for (size_t job = range.next.fetch_add(1); job < range.end; job = range.next.fetch_add(1))
+        {
+            (*pool.task)(worker, job);
+        }
+    }
+}
+
+/*
+Main loop of the threads of the pool, waiting for work from runJobs
+*/
+void workerLoop(WorkerPool& pool, size_t worker)
+{
+    size_t seen = 0;
+    while (true)
+    {
+        {
+            unique_lock<mutex> guard(pool.lock);
+            pool.wake.wait(guard, [&] { return pool.stopping || pool.generation != seen; });
+            if (pool.stopping)
+            {
+                return;
+            }
+            seen = pool.generation;
+        }
+        drainJobs(pool, worker);
+        {
+            lock_guard<mutex> guard(pool.lock);
+            if (--pool.busy == 0)
+            {
+                pool.finished.notify_one();
+            }
+        }
+    }
+}
+
+/*
+Starts the threads of a pool with the given number of workers, including the calling thread
+*/
+void startPool(WorkerPool& pool, size_t workers)
+{
+    pool.workers = max<size_t>(workers, 1);
+    pool.ranges.reset(new WorkRange[pool.workers]);
+    for (size_t w = 0; w + 1 < pool.workers; ++w)
+    {
+        pool.threads.emplace_back(workerLoop, ref(pool), w);
+    }
+}
+
+/*
+Stops and joins the threads of a pool
+*/
+void stopPool(WorkerPool& pool)
+{
+    {
+        lock_guard<mutex> guard(pool.lock);
+        pool.stopping = true;
+    }
+    pool.wake.notify_all();
+    for (auto& t : pool.threads)
+    {
+        t.join();
+    }
+    pool.threads.clear();
+}
+
+/*
+Runs task(worker, job) for every job from 0 to jobs - 1 on the workers of the pool
+and returns once all of them are done
+worker is the index of the worker running the job, so each one can keep its own state
+*/
+void runJobs(WorkerPool& pool, size_t jobs, const function<void(size_t, size_t)>& task)
+{
+    {
+        lock_guard<mutex> guard(pool.lock);
+        for (size_t w = 0; w < pool.workers; ++w)
+        {
+            pool.ranges[w].next.store(jobs * w / pool.workers);
+            pool.ranges[w].end = jobs * (w + 1) / pool.workers;
+        }
+        pool.task = &task;
+        pool.busy = pool.threads.size();
+        ++pool.generation;
+    }
+    pool.wake.notify_all();
+    drainJobs(pool, pool.workers - 1);
+    unique_lock<mutex> guard(pool.lock);
+    pool.finished.wait(guard, [&] { return pool.busy == 0; });
+}
+
+/*
+Converts a character of a puzzle in the 1 line format to the digit of a cell
+'0' and '.' are unassigned cells, and digits above 9 are letters: A (or a) is 10, B is 11 and so on
+Returns false if the character is not a cell of a board of the given size
+*/
+bool parseCellChar(char c, size_t size, uint8_t& digit)
+{
+    if (c == '.')
+    {
+        digit = 0;
+        return true;
+    }
+    size_t value = 0;
+    if (c >= '0' && c <= '9')
+    {
+        value = static_cast<size_t>(c - '0');
+    }
+    else if (c >= 'A' && c <= 'Z')
+    {
+        value = static_cast<size_t>(c - 'A') + 10;
+    }
+    else if (c >= 'a' && c <= 'z')
+    {
+        value = static_cast<size_t>(c - 'a') + 10;
+    }
+    else
+    {
+        return false;
+    }
+    if (value > size)
+    {
+        return false;
+    }
+    digit = static_cast<uint8_t>(value);
+    return true;
+}
+
+/*
+Undoes parseCellChar for a digit of a solution
+*/
+inline char cellChar(uint8_t digit)
+{
+    return static_cast<char>(digit < 10 ? '0' + digit : 'A' + digit - 10);
+}
+
+/*
+Reads a puzzle file, or the requests sent to the server on a connection, line by line in large blocks
+Lines are handed out as pointers into the block buffer, so nothing is copied or allocated per line
+*/
+struct PuzzleReader
+{
+    int fd = -1;
+    vector<char> buffer;
+    //The unread part of the buffer
+    size_t begin = 0;
+    size_t end = 0;
+    bool atEof = false;
+    size_t lineNumber = 0;
+};
+
+/*
+Size of the blocks read from a puzzle file and written to a solution file
+*/
+const size_t IO_BLOCK = 1 << 20;
+
+/*
+Opens a puzzle file for reading
+Returns false if it could not be opened
+*/
+bool openReader(PuzzleReader& reader, const string& path)
+{
+    reader.fd = open(path.c_str(), O_RDONLY);
+    reader.buffer.resize(IO_BLOCK);
+    return reader.fd >= 0;
+}
+
+/*
+Moves the unread part of the buffer to the front and reads the next block of the file after it
+The buffer grows when the unread part takes up more than half of it, as for a line longer than a block
+On a pipe or socket, this waits for some data, and reads whatever has arrived instead of a full block
+Sets atEof, and returns false, once the file has nothing more to read
+*/
+bool refillReader(PuzzleReader& reader)
+{
+    size_t partial = reader.end - reader.begin;
+    memmove(reader.buffer.data(), reader.buffer.data() + reader.begin, partial);
+    reader.begin = 0;
+    reader.end = partial;
+    if (reader.buffer.size() - partial < IO_BLOCK / 2)
+    {
+        reader.buffer.resize(reader.buffer.size() * 2);
+    }
+    ssize_t received = 0;
+    do
+    {
+        received = read(reader.fd, reader.buffer.data() + partial, reader.buffer.size() - partial);
+    } while (received < 0 && errno == EINTR);
+    reader.atEof = (received <= 0);
+    if (reader.atEof)
+    {
+        return false;
+    }
+    reader.end += static_cast<size_t>(received);
+    return true;
+}
+
+/*
+Gets the next line already in the reader's buffer, without its line ending, without reading more of the file
+At the end of the file, a last line without a line ending counts as a whole line
+line points into the reader's buffer and is only valid until the next refill
+Returns false if no whole line is left in the buffer
+*/
+bool takeLine(PuzzleReader& reader, const char*& line, size_t& length)
+{
+    char* start = reader.buffer.data() + reader.begin;
+    char* newline = static_cast<char*>(memchr(start, '\n', reader.end - reader.begin));
+    if (newline == nullptr && !(reader.atEof && reader.begin < reader.end))
+    {
+        return false;
+    }
+    size_t size = newline != nullptr ? static_cast<size_t>(newline - start) : reader.end - reader.begin;
+    reader.begin += size + (newline != nullptr);
+    if (size > 0 && start[size - 1] == '\r')
+    {
+        --size;
+    }
+    line = start;
+    length = size;
+    ++reader.lineNumber;
+    return true;
+}
+
+/*
+Gets the next line of the file, without its line ending
+line points into the reader's buffer and is only valid until the next call
+Returns false at the end of the file
+*/
+bool readLine(PuzzleReader& reader, const char*& line, size_t& length)
+{
+    while (!takeLine(reader, line, length))
+    {
+        if (reader.atEof)
+        {
+            return false;
+        }
+        //Read the rest of the partial line
+        refillReader(reader);
+    }
+    return true;
+}
+
+/*
+Exits with an error message about the current line of a puzzle file
+*/
+void inputError(const PuzzleReader& reader, const string& message, int code)
+{
+    cerr << "Error: " << message << " on line " << reader.lineNumber << '\n';
+    exit(code);
+}
+
+/*
+Reads the next puzzle of a batch input file straight into the cells of board
+A puzzle is either 1 line of 81 characters, or 9 lines of 9 space separated digits
+like Input1.txt (for other sizes, SIZE * SIZE characters or SIZE lines of SIZE numbers);
+blank lines between puzzles are skipped
+lineFormat records the format of the puzzle, so its solution is written the same way
+Returns false at the end of the file, and exits with an error message if the file is not valid
+*/
+template <size_t BOX>
+bool readPuzzle(PuzzleReader& reader, typename Sudoku<BOX>::Board& board, bool& lineFormat)
+{
+    using S = Sudoku<BOX>;
+    const size_t SIZE = S::SIZE;
+    const size_t CELLS = S::CELLS;
+    const char* line = nullptr;
+    size_t length = 0;
+    //Cells read so far of a puzzle in the 9 line format
+    size_t cell = 0;
+    while (readLine(reader, line, length))
+    {
+        size_t pos = 0;
+        while (pos < length && (line[pos] == ' ' || line[pos] == '\t'))
+        {
+            ++pos;
+        }
+        if (pos == length)
+        {
+            continue;
+        }
+        if (cell == 0 && length == CELLS && memchr(line, ' ', length) == nullptr)
+        {//A whole puzzle on 1 line
+            for (size_t i = 0; i < CELLS; ++i)
+            {
+                if (!parseCellChar(line[i], SIZE, board.cells[i]))
+                {
+                    inputError(reader, string("invalid cell value ") + line[i], 4);
+                }
+            }
+            lineFormat = true;
+            return true;
+        }
+        //1 row of a puzzle in the 9 line format, each token a number
+        size_t rowEnd = cell + SIZE;
+        while (pos < length)
+        {
+            if (line[pos] == ' ' || line[pos] == '\t')
+            {
+                ++pos;
+                continue;
+            }
+            size_t tokenEnd = pos;
+            while (tokenEnd < length && line[tokenEnd] != ' ' && line[tokenEnd] != '\t')
+            {
+                ++tokenEnd;
+            }
+            if (cell == rowEnd)
+            {
+                inputError(reader, "row of the wrong length", 2);
+            }
+            if (!S::parseCell(line + pos, tokenEnd - pos, board.cells[cell]))
+            {
+                inputError(reader, "invalid cell value", 4);
+            }
+            ++cell;
+            pos = tokenEnd;
+        }
+        if (cell != rowEnd)
+        {
+            inputError(reader, "row of the wrong length", 2);
+        }
+        if (cell == CELLS)
+        {
+            lineFormat = false;
+            return true;
+        }
+    }
+    if (cell != 0)
+    {
+        cerr << "Error: incomplete board at the end of the input\n";
+        exit(2);
+    }
+    return false;
+}
+
+/*
+Writes solutions to a file through a reusable buffer that is written out in large blocks
+*/
+struct SolutionWriter
+{
+    FILE* file = nullptr;
+    vector<char> buffer;
+    size_t used = 0;
+};
+
+/*
+Opens a solution file for writing
+Returns false if it could not be opened
+*/
+bool openWriter(SolutionWriter& writer, const string& path)
+{
+    writer.file = fopen(path.c_str(), "wb");
+    writer.buffer.resize(IO_BLOCK);
+    return writer.file != nullptr;
+}
+
+/*
+Writes out the buffered solutions
+*/
+void flushWriter(SolutionWriter& writer)
+{
+    if (writer.used > 0 && fwrite(writer.buffer.data(), 1, writer.used, writer.file) != writer.used)
+    {
+        cerr << "Could not write output file\n";
+        exit(3);
+    }
+    writer.used = 0;
+}
+
+/*
+Formats the number of solutions found for a puzzle into the writer's buffer, on its own line
+A search that ran out of budget is written as "N aborted", it found at least N solutions
+*/
+void writeCount(SolutionWriter& writer, size_t count, bool aborted)
+{
+    //Room for any number of solutions
+    const size_t maxSize = 24;
+    if (writer.buffer.size() - writer.used < maxSize)
+    {
+        flushWriter(writer);
+    }
+    writer.used += static_cast<size_t>(snprintf(writer.buffer.data() + writer.used, maxSize, aborted ? "%zu aborted\n" : "%zu\n", count));
+}
+
+/*
+Header of a search statistics file, with 1 row per puzzle written by writeStats
+*/
+const char STATS_HEADER[] =
+    "puzzle,seed,solutions,aborted,nodes,guesses,backtracks,propagations,mrv_decisions,degree_decisions,tie_breaks,max_depth\n";
+
+/*
+Formats the search statistics of puzzle number puzzle, searched with the given seed, into the writer's buffer, as a CSV row
+*/
+void writeStats(SolutionWriter& writer, size_t puzzle, uint64_t seed, size_t solutions, bool aborted,
+                const SearchStats& stats)
+{
+    //Room for 12 numbers and their commas
+    const size_t maxSize = 12 * 21;
+    if (writer.buffer.size() - writer.used < maxSize)
+    {
+        flushWriter(writer);
+    }
+    writer.used += static_cast<size_t>(snprintf(writer.buffer.data() + writer.used, maxSize,
+        "%zu,%llu,%zu,%d,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu\n", puzzle, static_cast<unsigned long long>(seed), solutions,
+        aborted ? 1 : 0, stats.nodes, stats.guesses,
+        stats.backtracks, stats.propagations, stats.mrvDecisions, stats.degreeDecisions, stats.tieBreaks,
+        stats.maxDepth));
+}
+
+/*
+Opens a search statistics file and writes its header
+*/
+void openStats(SolutionWriter& writer, const string& path)
+{
+    if (!openWriter(writer, path))
+    {
+        cerr << "Could not open stats file\n";
+        exit(3);
+    }
+    memcpy(writer.buffer.data(), STATS_HEADER, sizeof(STATS_HEADER) - 1);
+    writer.used = sizeof(STATS_HEADER) - 1;
+}
+
+/*
+Formats the solution of a puzzle into the writer's buffer, in the format the puzzle was read in
+Puzzles without a solution are written as "No solution", or "Aborted" if their search ran out of budget
+*/
+template <size_t BOX>
+void writeSolution(SolutionWriter& writer, const typename Sudoku<BOX>::Board& board, bool solved, bool aborted,
+                   bool lineFormat)
+{
+    const size_t SIZE = Sudoku<BOX>::SIZE;
+    const size_t CELLS = Sudoku<BOX>::CELLS;
+    //Largest size of a formatted solution: SIZE lines of numbers of up to 2 digits and spaces, and a blank line
+    const size_t maxSize = 3 * CELLS + 1;
+    if (writer.buffer.size() - writer.used < maxSize)
+    {
+        flushWriter(writer);
+    }
+    char* out = writer.buffer.data() + writer.used;
+    if (!solved)
+    {
+        static const char noSolution[] = "No solution\n";
+        static const char abortedSearch[] = "Aborted\n";
+        const char* text = aborted ? abortedSearch : noSolution;
+        size_t length = aborted ? sizeof(abortedSearch) - 1 : sizeof(noSolution) - 1;
+        memcpy(out, text, length);
+        out += length;
+    }
+    else if (lineFormat)
+    {
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            *out++ = cellChar(board.cells[cell]);
+        }
+        *out++ = '\n';
+    }
+    else
+    {
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            uint8_t digit = board.cells[cell];
+            if (digit >= 10)
+            {
+                *out++ = static_cast<char>('0' + digit / 10);
+            }
+            *out++ = static_cast<char>('0' + digit % 10);
+            *out++ = (Sudoku<BOX>::colOf(cell) == SIZE - 1) ? '\n' : ' ';
+        }
+    }
+    if (!lineFormat)
+    {//Blank line between puzzles in the 9 line format
+        *out++ = '\n';
+    }
+    writer.used = static_cast<size_t>(out - writer.buffer.data());
+}
+
+/*
+Packed binary format of puzzles and solutions, for storing and moving many boards
+A packed file starts with an 8 byte header: the magic "SDKP", the version, the width of the grids (BOX)
+and the number of bits per cell, then a 0 byte. Each board follows as a record of the same size: a status
+byte, then the cells row by row, PACKED_BITS bits each from the lowest bit of each byte up, 0 for a blank cell
+A 9x9 record is 42 bytes, against 82 in the 1 line format and about 170 in the 9 line format
+*/
+const char PACKED_MAGIC[4] = {'S', 'D', 'K', 'P'};
+const uint8_t PACKED_VERSION = 1;
+const size_t PACKED_HEADER = 8;
+
+/*
+Status of a packed record: a puzzle to solve, or the result of solving one
+A record that was solved holds the solution, and one that was not holds the puzzle
+*/
+enum class RecordStatus : uint8_t { PUZZLE, SOLVED, NO_SOLUTION, ABORTED };
+
+/*
+Bits per cell in the packed format: 4 hold the digits of boards up to 9x9, and 5 those up to 25x25
+*/
+template <size_t BOX>
+constexpr size_t PACKED_BITS = BOX <= 3 ? 4 : 5;
+
+template <size_t BOX>
+constexpr size_t PACKED_RECORD = 1 + (Sudoku<BOX>::CELLS * PACKED_BITS<BOX> + 7) / 8;
+
+/*
+Packs the cells of a board and its status into a record
+*/
+template <size_t BOX>
+void packRecord(const uint8_t* cells, RecordStatus status, uint8_t* record)
+{
+    const size_t CELLS = Sudoku<BOX>::CELLS;
+    const size_t BITS = PACKED_BITS<BOX>;
+    record[0] = static_cast<uint8_t>(status);
+    uint8_t* out = record + 1;
+    //Bits not written out yet, the oldest in the lowest bits
+    uint32_t pending = 0;
+    size_t pendingBits = 0;
+    for (size_t cell = 0; cell < CELLS; ++cell)
+    {
+        pending |= static_cast<uint32_t>(cells[cell]) << pendingBits;
+        pendingBits += BITS;
+        while (pendingBits >= 8)
+        {
+            *out++ = static_cast<uint8_t>(pending);
+            pending >>= 8;
+            pendingBits -= 8;
+        }
+    }
+    if (pendingBits > 0)
+    {
+        *out = static_cast<uint8_t>(pending);
+    }
+}
+
+/*
+Undoes packRecord
+Returns false if the record is not valid: an unknown status, or a cell above SIZE
+*/
+template <size_t BOX>
+bool unpackRecord(const uint8_t* record, uint8_t* cells, RecordStatus& status)
+{
+    const size_t SIZE = Sudoku<BOX>::SIZE;
+    const size_t CELLS = Sudoku<BOX>::CELLS;
+    const size_t BITS = PACKED_BITS<BOX>;
+    if (record[0] > static_cast<uint8_t>(RecordStatus::ABORTED))
+    {
+        return false;
+    }
+    status = static_cast<RecordStatus>(record[0]);
+    const uint8_t* in = record + 1;
+    uint32_t pending = 0;
+    size_t pendingBits = 0;
+    bool valid = true;
+    for (size_t cell = 0; cell < CELLS; ++cell)
+    {
+        if (pendingBits < BITS)
+        {
+            pending |= static_cast<uint32_t>(*in++) << pendingBits;
+            pendingBits += 8;
+        }
+        cells[cell] = static_cast<uint8_t>(pending & ((1u << BITS) - 1));
+        pending >>= BITS;
+        pendingBits -= BITS;
+        valid &= cells[cell] <= SIZE;
+    }
+    return valid;
+}
+
+/*
+Makes sure the reader's buffer holds at least size unread bytes, reading more of the file if needed
+Returns false if the file ends before that
+*/
+bool fillReader(PuzzleReader& reader, size_t size)
+{
+    while (reader.end - reader.begin < size && !reader.atEof)
+    {
+        refillReader(reader);
+    }
+    return reader.end - reader.begin >= size;
+}
+
+/*
+Reads the header of a packed file, if the file starts with one
+Returns false, reading nothing, if the file is not packed, and exits with an error message
+if it is packed for another board size
+*/
+template <size_t BOX>
+bool readPackedHeader(PuzzleReader& reader)
+{
+    if (!fillReader(reader, PACKED_HEADER) || memcmp(reader.buffer.data() + reader.begin, PACKED_MAGIC, 4) != 0)
+    {
+        return false;
+    }
+    const uint8_t* header = reinterpret_cast<const uint8_t*>(reader.buffer.data() + reader.begin);
+    if (header[4] != PACKED_VERSION || header[5] != BOX || header[6] != PACKED_BITS<BOX>)
+    {
+        cerr << "Error: the packed file is of another version or board size\n";
+        exit(2);
+    }
+    reader.begin += PACKED_HEADER;
+    return true;
+}
+
+/*
+Reads the next record of a packed file into cells and status
+Returns false at the end of the file, and exits with an error message if the record is not valid
+*/
+template <size_t BOX>
+bool readRecord(PuzzleReader& reader, uint8_t* cells, RecordStatus& status)
+{
+    const size_t RECORD = PACKED_RECORD<BOX>;
+    if (!fillReader(reader, RECORD))
+    {
+        if (reader.end != reader.begin)
+        {
+            cerr << "Error: incomplete record at the end of the packed file\n";
+            exit(2);
+        }
+        return false;
+    }
+    ++reader.lineNumber;
+    if (!unpackRecord<BOX>(reinterpret_cast<const uint8_t*>(reader.buffer.data() + reader.begin), cells, status))
+    {
+        cerr << "Error: invalid record " << reader.lineNumber << " of the packed file\n";
+        exit(4);
+    }
+    reader.begin += RECORD;
+    return true;
+}
+
+/*
+Writes the header of a packed file for boards of BOX x BOX grids into the writer's buffer
+*/
+template <size_t BOX>
+void writePackedHeader(SolutionWriter& writer)
+{
+    if (writer.buffer.size() - writer.used < PACKED_HEADER)
+    {
+        flushWriter(writer);
+    }
+    uint8_t* out = reinterpret_cast<uint8_t*>(writer.buffer.data() + writer.used);
+    memcpy(out, PACKED_MAGIC, 4);
+    out[4] = PACKED_VERSION;
+    out[5] = static_cast<uint8_t>(BOX);
+    out[6] = static_cast<uint8_t>(PACKED_BITS<BOX>);
+    out[7] = 0;
+    writer.used += PACKED_HEADER;
+}
+
+/*
+Packs a board and its status into the writer's buffer
+*/
+template <size_t BOX>
+void writeRecord(SolutionWriter& writer, const uint8_t* cells, RecordStatus status)
+{
+    if (writer.buffer.size() - writer.used < PACKED_RECORD<BOX>)
+    {
+        flushWriter(writer);
+    }
+    packRecord<BOX>(cells, status, reinterpret_cast<uint8_t*>(writer.buffer.data() + writer.used));
+    writer.used += PACKED_RECORD<BOX>;
+}
+
+/*
+Solver settings of a benchmark run, named after them: engine-propagation-logic like csp-ac3-pre, or dlx
+*/
+struct BenchConfig
+{
+    string name;
+    SolveOptions options;
+};
+
+/*
+Configurations benchmarked when --configs is not given
+The logic rules are left on, since without them some pathological puzzles take minutes
+*/
+const char* const DEFAULT_BENCH_CONFIGS = "csp-ac3-pre,csp-ac3-node,csp-forward-pre,dlx";
+
+/*
+Reads a configuration name into config, on top of the options of base
+Returns false if the name is not valid
+*/
+bool parseBenchConfig(const string& name, const SolveOptions& base, BenchConfig& config)
+{
+    config.name = name;
+    config.options = base;
+    if (name == "dlx")
+    {
+        config.options.engine = Engine::DLX;
+        return true;
+    }
+    config.options.engine = Engine::CSP;
+    size_t first = name.find('-');
+    size_t second = name.find('-', first + 1);
+    if (first == string::npos || second == string::npos || name.substr(0, first) != "csp")
+    {
+        return false;
+    }
+    string propagation = name.substr(first + 1, second - first - 1);
+    string logic = name.substr(second + 1);
+    if (propagation == "none")
+    {
+        config.options.propagation = Propagation::NONE;
+    }
+    else if (propagation == "forward")
+    {
+        config.options.propagation = Propagation::FORWARD;
+    }
+    else if (propagation == "ac3")
+    {
+        config.options.propagation = Propagation::AC3;
+    }
+    else
+    {
+        return false;
+    }
+    if (logic == "off")
+    {
+        config.options.logicMode = LogicMode::OFF;
+    }
+    else if (logic == "pre")
+    {
+        config.options.logicMode = LogicMode::PRE;
+    }
+    else if (logic == "node")
+    {
+        config.options.logicMode = LogicMode::NODE;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+/*
+Reads a comma separated list of configuration names into configs
+Returns false if one of them is not valid
+*/
+bool parseBenchConfigs(const string& list, const SolveOptions& base, vector<BenchConfig>& configs)
+{
+    configs.clear();
+    size_t begin = 0;
+    while (begin <= list.size())
+    {
+        size_t end = min(list.find(',', begin), list.size());
+        BenchConfig config;
+        if (!parseBenchConfig(list.substr(begin, end - begin), base, config))
+        {
+            return false;
+        }
+        configs.push_back(config);
+        begin = end + 1;
+    }
+    return true;
+}
+
+/*
+Settings of the program, read from the command line
+*/
+struct CommandLine
+{
+    SolveOptions options;
+    //Unless a seed is given, every run uses a different one
+    uint64_t seed = static_cast<uint64_t>(chrono::steady_clock::now().time_since_epoch().count());
+    bool batch = false;
+    //Set by --lockstep, which settles what it can of the puzzles of batch mode with singles, many puzzles at a time
+    bool lockstep = false;
+    //Set by --count, which writes out the number of solutions instead of a solution
+    bool counting = false;
+    size_t threads = max<size_t>(thread::hardware_concurrency(), 1);
+    //Set by --split, which searches a single puzzle on the threads by splitting the top levels of its search tree
+    size_t splitDepth = 0;
+    //Width of the grids of the board, set by --size
+    size_t box = 3;
+    string input = "Input1.txt";
+    string output = "Output1.txt";
+    //File the search statistics of every puzzle are written to, set by --stats
+    string statsFile;
+    //Set by --cache, which answers puzzles that are symmetries of ones already solved from a SolutionCache,
+    //the file it is kept in between runs, set by --cache-file, and the most puzzles it keeps, set by --cache-size
+    //The default keeps the cache to a few tens of megabytes, even in a server that runs for a long time
+    bool cache = false;
+    string cacheFile;
+    size_t cacheSize = 100000;
+    //Set by --packed, which writes the solutions of batch mode in the packed format,
+    //and by --pack and --unpack, which convert puzzles between the text and packed formats without solving them
+    bool packed = false;
+    bool pack = false;
+    bool unpack = false;
+    //Set by --serve, which answers puzzles sent on stdin, or on the Unix socket given with --socket
+    bool serve = false;
+    string socketPath;
+    //Benchmark mode: corpora given with --bench, and the configurations to run them with
+    vector<string> benchCorpora;
+    string benchConfigs = DEFAULT_BENCH_CONFIGS;
+    size_t benchRepeat = 5;
+    size_t benchWarmup = 1;
+    bool benchJson = false;
+};
+
+/*
+Returns true if the search depends on the seed, which it only does when the degree heuristic breaks ties at random
+Runs that depend on it report the seed they used, so they can be reproduced with --seed
+*/
+bool usesSeed(const SolveOptions& options)
+{
+    return options.engine == Engine::CSP && options.tieBreak == TieBreak::RANDOM;
+}
+
+/*
+Result of solving 1 puzzle in batch or server mode, see solvePuzzle
+*/
+struct PuzzleResult
+{
+    size_t solutions = 0;
+    bool aborted = false;
+    bool fromCache = false;
+    SearchStats stats;
+};
+
+/*
+Solves the puzzle in cells with solver, writing its solution over cells, or with --count counts its solutions
+With a cache, the puzzle is looked up in it first, and added to it once solved
+Seeding each puzzle with its own seed gives the same result no matter which worker solves it
+*/
+template <size_t BOX>
+void solvePuzzle(const CommandLine& cmd, Solver<BOX>& solver, SolutionCache* cache, uint64_t seed, uint8_t* cells,
+                 PuzzleResult& result)
+{
+    SolutionCache::CanonicalForm form;
+    bool cacheable = cache != nullptr && SolutionCache::canonicalize(cells, form);
+    bool solved = false;
+    result.fromCache = cacheable && cache->find(form, cells, solved);
+    if (result.fromCache)
+    {
+        result.solutions = solved;
+        result.aborted = false;
+        result.stats = SearchStats{};
+        return;
+    }
+    solver.setSeed(seed);
+    if (cmd.counting)
+    {
+        result.solutions = solver.count(cells, cmd.options.solutionLimit);
+    }
+    else
+    {
+        result.solutions = solver.solve(cells);
+    }
+    result.aborted = solver.aborted();
+    result.stats = solver.stats();
+    //A search that ran out of budget has not settled whether the puzzle has a solution
+    if (cacheable && !result.aborted)
+    {
+        cache->insert(form, result.solutions > 0 ? cells : nullptr);
+    }
+}
+
+/*
+Creates the cache of --cache, read from the file of --cache-file if there is one, or returns null without --cache
+*/
+unique_ptr<SolutionCache> openCache(const CommandLine& cmd)
+{
+    if (!cmd.cache)
+    {
+        return nullptr;
+    }
+    auto cache = make_unique<SolutionCache>(cmd.cacheSize);
+    //The file is created at the end of the first run that uses it
+    if (!cmd.cacheFile.empty() && ifstream(cmd.cacheFile) && !cache->load(cmd.cacheFile))
+    {
+        cerr << "Could not read cache file\n";
+        exit(1);
+    }
+    return cache;
+}
+
+/*
+Number of 9x9 puzzles read, solved and written at a time in batch mode
+Chunks of bigger boards hold fewer puzzles, so that they take about as much memory
+*/
+const size_t BATCH_CHUNK = 1 << 14;
+
+/*
+Applies naked and hidden singles to the first count puzzles of chunk in lockstep, LANES puzzles at a time on each worker
+Writes the results of the puzzles this settles, and the positions of the others in open, left for the search
+Returns the number of puzzles left open
+*/
+template <size_t BOX>
+size_t settleLockstep(WorkerPool& pool, vector<typename Sudoku<BOX>::LockstepGroup>& groups,
+                      vector<typename Sudoku<BOX>::Board>& chunk, size_t count, vector<PuzzleResult>& results,
+                      vector<size_t>& open)
+{
+    using S = Sudoku<BOX>;
+    runJobs(pool, (count + S::LANES - 1) / S::LANES, [&](size_t worker, size_t job)
+    {
+        typename S::LockstepGroup& group = groups[worker];
+        size_t begin = job * S::LANES;
+        size_t lanes = min(S::LANES, count - begin);
+        for (size_t lane = 0; lane < S::LANES; ++lane)
+        {
+            S::setLane(group, lane, lane < lanes ? chunk[begin + lane].cells : nullptr);
+        }
+        S::propagateLockstep(group);
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            PuzzleResult& result = results[begin + lane];
+            result = PuzzleResult{};
+            if (group.status[lane] == S::LaneStatus::SOLVED)
+            {
+                S::getLane(group, lane, chunk[begin + lane].cells);
+                result.solutions = 1;
+            }
+            open[begin + lane] = group.status[lane] == S::LaneStatus::OPEN;
+        }
+    });
+    //open holds a flag for each puzzle, turned into the positions of the flagged ones in place
+    size_t numOpen = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (open[i] != 0)
+        {
+            open[numOpen++] = i;
+        }
+    }
+    return numOpen;
+}
+
+/*
+Solves every puzzle of the input file on a pool of threads,
+and writes the solutions (or with --count, their number) to the output file in the same order
+The file is streamed through in chunks of puzzles, so it can be larger than memory
+Each worker has its own search, so solving needs no locks
+With --cache, puzzles are looked up in a SolutionCache shared by the workers before they are solved
+With --lockstep, singles settle what they can of each chunk first, see settleLockstep
+*/
+template <size_t BOX>
+void runBatch(const CommandLine& cmd)
+{
+    using S = Sudoku<BOX>;
+    PuzzleReader reader;
+    if (!openReader(reader, cmd.input))
+    {
+        cerr << "Could not open input file\n";
+        exit(1);
+    }
+    SolutionWriter writer;
+    if (!openWriter(writer, cmd.output))
+    {
+        cerr << "Could not open output file\n";
+        exit(3);
+    }
+    bool stats = !cmd.statsFile.empty();
+    SolutionWriter statsWriter;
+    if (stats)
+    {
+        openStats(statsWriter, cmd.statsFile);
+    }
+    unique_ptr<SolutionCache> cache = openCache(cmd);
+    //Packed input is read as such, whatever the output format
+    bool packedInput = readPackedHeader<BOX>(reader);
+    if (cmd.packed)
+    {
+        writePackedHeader<BOX>(writer);
+    }
+
+    WorkerPool pool;
+    startPool(pool, cmd.threads);
+    vector<Solver<BOX>> solvers;
+    for (size_t worker = 0; worker < pool.workers; ++worker)
+    {
+        solvers.emplace_back(cmd.options);
+    }
+    const size_t chunkSize = max<size_t>(BATCH_CHUNK * 81 / S::CELLS, 1);
+    vector<typename S::Board> chunk(chunkSize);
+    vector<char> lineFormat(chunkSize);
+    vector<PuzzleResult> results(chunkSize);
+    vector<typename S::LockstepGroup> groups(cmd.lockstep ? pool.workers : 0);
+    //Positions in the chunk of the puzzles to search
+    vector<size_t> open(chunkSize);
+    //Index in the file of the first puzzle of the chunk
+    size_t first = 0;
+    size_t numSolved = 0;
+    size_t numAborted = 0;
+    size_t numCached = 0;
+    while (true)
+    {
+        size_t count = 0;
+        //Packed puzzles are written out in the 1 line format
+        bool format = packedInput;
+        RecordStatus status;
+        while (count < chunkSize && (packedInput ? readRecord<BOX>(reader, chunk[count].cells, status)
+                                                 : readPuzzle<BOX>(reader, chunk[count], format)))
+        {
+            lineFormat[count++] = format;
+        }
+        if (count == 0)
+        {
+            break;
+        }
+        size_t numOpen = count;
+        if (cmd.lockstep)
+        {
+            numOpen = settleLockstep<BOX>(pool, groups, chunk, count, results, open);
+        }
+        else
+        {
+            iota(open.begin(), open.begin() + count, 0);
+        }
+        runJobs(pool, numOpen, [&](size_t worker, size_t job)
+        {
+            size_t i = open[job];
+            solvePuzzle<BOX>(cmd, solvers[worker], cache.get(), cmd.seed + first + i, chunk[i].cells, results[i]);
+        });
+        for (size_t i = 0; i < count; ++i)
+        {
+            const PuzzleResult& result = results[i];
+            if (cmd.counting)
+            {
+                writeCount(writer, result.solutions, result.aborted);
+            }
+            else if (cmd.packed)
+            {
+                writeRecord<BOX>(writer, chunk[i].cells, result.solutions > 0 ? RecordStatus::SOLVED :
+                                 result.aborted ? RecordStatus::ABORTED : RecordStatus::NO_SOLUTION);
+            }
+            else
+            {
+                writeSolution<BOX>(writer, chunk[i], result.solutions > 0, result.aborted, lineFormat[i]);
+            }
+            if (stats)
+            {
+                writeStats(statsWriter, first + i, cmd.seed + first + i, result.solutions, result.aborted, result.stats);
+            }
+            numSolved += (result.solutions > 0);
+            numAborted += result.aborted;
+            numCached += result.fromCache;
+        }
+        first += count;
+    }
+    stopPool(pool);
+    flushWriter(writer);
+    fclose(writer.file);
+    if (stats)
+    {
+        flushWriter(statsWriter);
+        fclose(statsWriter.file);
+    }
+    close(reader.fd);
+    cout << "Solved " << numSolved << " of " << first << " puzzles";
+    if (numAborted > 0)
+    {
+        cout << ", " << numAborted << " aborted";
+    }
+    if (usesSeed(cmd.options))
+    {//Puzzle i is searched with seed + i, so the run can be reproduced with --seed
+        cout << ", seed " << cmd.seed;
+    }
+    if (cache)
+    {
+        cout << ", " << numCached << " from the cache";
+        if (!cmd.cacheFile.empty() && !cache->save(cmd.cacheFile))
+        {
+            cerr << "Could not write cache file\n";
+            exit(3);
+        }
+    }
+    cout << '\n';
+}
+
+/*
+Most requests of a connection solved at a time in server mode
+The requests already received are solved together on the pool, up to this many, and answered in order
+*/
+const size_t SERVER_CHUNK = 256;
+
+/*
+Request of the server: a puzzle in the 1 line format, optionally followed by the word stats,
+which adds the search statistics and the time taken to the answer
+error is set, and the puzzle is not solved, if the request is not valid
+*/
+struct Request
+{
+    bool stats = false;
+    const char* error = nullptr;
+};
+
+/*
+Reads a request line of the server into cells and request
+Returns false if the line is blank, which is not a request and gets no answer
+*/
+template <size_t BOX>
+bool parseRequest(const char* line, size_t length, uint8_t* cells, Request& request)
+{
+    const size_t SIZE = Sudoku<BOX>::SIZE;
+    const size_t CELLS = Sudoku<BOX>::CELLS;
+    size_t pos = 0;
+    while (pos < length && (line[pos] == ' ' || line[pos] == '\t'))
+    {
+        ++pos;
+    }
+    while (length > pos && (line[length - 1] == ' ' || line[length - 1] == '\t'))
+    {
+        --length;
+    }
+    if (pos == length)
+    {
+        return false;
+    }
+    request = Request{};
+    size_t puzzleEnd = pos;
+    while (puzzleEnd < length && line[puzzleEnd] != ' ' && line[puzzleEnd] != '\t')
+    {
+        ++puzzleEnd;
+    }
+    if (puzzleEnd - pos != CELLS)
+    {
+        request.error = "the puzzle has the wrong number of cells";
+        return true;
+    }
+    for (size_t i = 0; i < CELLS; ++i)
+    {
+        if (!parseCellChar(line[pos + i], SIZE, cells[i]))
+        {
+            request.error = "invalid cell value";
+            return true;
+        }
+    }
+    pos = puzzleEnd;
+    while (pos < length && (line[pos] == ' ' || line[pos] == '\t'))
+    {
+        ++pos;
+    }
+    if (length - pos == 5 && memcmp(line + pos, "stats", 5) == 0)
+    {
+        request.stats = true;
+    }
+    else if (pos < length)
+    {
+        request.error = "unknown option after the puzzle";
+    }
+    return true;
+}
+
+/*
+Room for the end of an answer of the server after the solution: the statistics and the line ending
+*/
+const size_t STATS_ROOM = 8 * 24;
+
+/*
+Formats the answer to a request into the writer's buffer, on 1 line: the solution in the 1 line format,
+"No solution" or "Aborted" (or with --count, the number of solutions), or "Error: " and what is wrong with the request
+With stats requested, the search statistics and the time taken in microseconds follow, as name=value
+The buffer must have room for the answer, which is never flushed in the middle
+*/
+template <size_t BOX>
+void writeAnswer(SolutionWriter& writer, const uint8_t* cells, const Request& request, const PuzzleResult& result,
+                 bool counting, double micros)
+{
+    const size_t CELLS = Sudoku<BOX>::CELLS;
+    char* out = writer.buffer.data() + writer.used;
+    if (request.error != nullptr)
+    {
+        out += snprintf(out, STATS_ROOM + CELLS, "Error: %s", request.error);
+    }
+    else if (counting)
+    {
+        out += snprintf(out, STATS_ROOM, result.aborted ? "%zu aborted" : "%zu", result.solutions);
+    }
+    else if (result.solutions > 0)
+    {
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            *out++ = cellChar(cells[cell]);
+        }
+    }
+    else
+    {
+        out += snprintf(out, STATS_ROOM, "%s", result.aborted ? "Aborted" : "No solution");
+    }
+    if (request.stats && request.error == nullptr)
+    {
+        const SearchStats& stats = result.stats;
+        out += snprintf(out, STATS_ROOM, " nodes=%zu guesses=%zu backtracks=%zu propagations=%zu max_depth=%zu cached=%d us=%.1f",
+                        stats.nodes, stats.guesses, stats.backtracks, stats.propagations, stats.maxDepth,
+                        result.fromCache ? 1 : 0, micros);
+    }
+    *out++ = '\n';
+    writer.used = static_cast<size_t>(out - writer.buffer.data());
+}
+
+/*
+State of the server kept from 1 request to the next: the pool, a solver for each of its workers,
+allocated once, and the cache
+Connections take turns running their requests on the pool
+*/
+template <size_t BOX>
+struct Server
+{
+    WorkerPool pool;
+    vector<Solver<BOX>> solvers;
+    unique_ptr<SolutionCache> cache;
+    //Held while a connection runs requests on the pool or writes the cache file
+    mutex lock;
+};
+
+/*
+Answers the requests of 1 connection, read from the file descriptor in and written to out, until the client closes it
+The requests already received are solved together on the pool and answered in the order they came in,
+so a client can send many requests without waiting for each answer
+Returns false if the answers could not be written, as when the client went away
+*/
+template <size_t BOX>
+bool serveConnection(const CommandLine& cmd, Server<BOX>& server, int in, FILE* out)
+{
+    const size_t CELLS = Sudoku<BOX>::CELLS;
+    PuzzleReader reader;
+    reader.fd = in;
+    reader.buffer.resize(IO_BLOCK);
+    SolutionWriter writer;
+    writer.file = out;
+    writer.buffer.resize(SERVER_CHUNK * (CELLS + STATS_ROOM));
+    vector<uint8_t> cells(SERVER_CHUNK * CELLS);
+    vector<Request> requests(SERVER_CHUNK);
+    vector<PuzzleResult> results(SERVER_CHUNK);
+    vector<double> micros(SERVER_CHUNK);
+    //Requests answered before the chunk, which seeds the search of each request
+    size_t answered = 0;
+    while (true)
+    {
+        size_t count = 0;
+        const char* line = nullptr;
+        size_t length = 0;
+        //Only the requests already received are taken, so none waits for the ones after it
+        while (count < SERVER_CHUNK && takeLine(reader, line, length))
+        {
+            count += parseRequest<BOX>(line, length, &cells[count * CELLS], requests[count]);
+        }
+        if (count == 0)
+        {
+            if (reader.atEof)
+            {
+                return true;
+            }
+            refillReader(reader);
+            continue;
+        }
+        {
+            lock_guard<mutex> guard(server.lock);
+            runJobs(server.pool, count, [&](size_t worker, size_t job)
+            {
+                if (requests[job].error != nullptr)
+                {
+                    return;
+                }
+                auto start = chrono::steady_clock::now();
+                solvePuzzle<BOX>(cmd, server.solvers[worker], server.cache.get(), cmd.seed + answered + job,
+                                 &cells[job * CELLS], results[job]);
+                micros[job] = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+            });
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            writeAnswer<BOX>(writer, &cells[i * CELLS], requests[i], results[i], cmd.counting, micros[i]);
+        }
+        answered += count;
+        if (fwrite(writer.buffer.data(), 1, writer.used, out) != writer.used || fflush(out) != 0)
+        {
+            return false;
+        }
+        writer.used = 0;
+    }
+}
+
+/*
+Opens a Unix domain socket at path and listens on it, replacing a socket left there by a server that was stopped
+Exits with an error message if it cannot
+*/
+int listenOn(const string& path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        cerr << "Socket path too long\n";
+        exit(1);
+    }
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    struct stat status;
+    if (stat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+    {
+        unlink(path.c_str());
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, SOMAXCONN) != 0)
+    {
+        cerr << "Could not listen on socket " << path << '\n';
+        exit(3);
+    }
+    return listener;
+}
+
+/*
+Runs the solver as a server, which keeps its pool, solvers and cache between requests, so a request costs
+only its search: no process to start, file to open or memory to allocate
+Requests are read on stdin and answered on stdout until stdin is closed, or with --socket, read and
+answered on each connection to a Unix domain socket, each served by its own thread, until the server is stopped
+*/
+template <size_t BOX>
+void runServer(const CommandLine& cmd)
+{
+    Server<BOX> server;
+    server.cache = openCache(cmd);
+    if (usesSeed(cmd.options))
+    {//On stderr, which is not part of the answers
+        cerr << "Seed: " << cmd.seed << '\n';
+    }
+    startPool(server.pool, cmd.threads);
+    for (size_t worker = 0; worker < server.pool.workers; ++worker)
+    {
+        server.solvers.emplace_back(cmd.options);
+    }
+    if (cmd.socketPath.empty())
+    {
+        serveConnection<BOX>(cmd, server, STDIN_FILENO, stdout);
+        stopPool(server.pool);
+        if (server.cache && !cmd.cacheFile.empty() && !server.cache->save(cmd.cacheFile))
+        {
+            cerr << "Could not write cache file\n";
+            exit(3);
+        }
+        return;
+    }
+    //A client that goes away is handled by its connection, instead of stopping the server
+    signal(SIGPIPE, SIG_IGN);
+    int listener = listenOn(cmd.socketPath);
+    cerr << "Listening on " << cmd.socketPath << '\n';
+    while (true)
+    {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            cerr << "Could not accept a connection\n";
+            exit(3);
+        }
+        thread([&cmd, &server, fd]
+        {
+            FILE* out = fdopen(fd, "wb");
+            if (out == nullptr)
+            {
+                close(fd);
+                return;
+            }
+            serveConnection<BOX>(cmd, server, fd, out);
+            fclose(out);
+            //The cache file is kept up to date with each client that is done
+            if (server.cache && !cmd.cacheFile.empty())
+            {
+                lock_guard<mutex> guard(server.lock);
+                if (!server.cache->save(cmd.cacheFile))
+                {
+                    cerr << "Could not write cache file\n";
+                }
+            }
+        }).detach();
+    }
+}
+
+/*
+Converts the puzzles of the input file between the text and packed formats, without solving them
+With --pack, puzzles in either text format are written as packed records, and with --unpack, packed records
+are written in the 1 line format: puzzles as they are, with 0 for a blank cell, and results as in batch mode
+*/
+template <size_t BOX>
+void runConvert(const CommandLine& cmd)
+{
+    PuzzleReader reader;
+    if (!openReader(reader, cmd.input))
+    {
+        cerr << "Could not open input file\n";
+        exit(1);
+    }
+    SolutionWriter writer;
+    if (!openWriter(writer, cmd.output))
+    {
+        cerr << "Could not open output file\n";
+        exit(3);
+    }
+    typename Sudoku<BOX>::Board board;
+    size_t count = 0;
+    if (cmd.pack)
+    {
+        writePackedHeader<BOX>(writer);
+        bool format = false;
+        while (readPuzzle<BOX>(reader, board, format))
+        {
+            writeRecord<BOX>(writer, board.cells, RecordStatus::PUZZLE);
+            ++count;
+        }
+    }
+    else
+    {
+        if (!readPackedHeader<BOX>(reader))
+        {
+            cerr << "Error: the input file is not packed\n";
+            exit(2);
+        }
+        RecordStatus status;
+        while (readRecord<BOX>(reader, board.cells, status))
+        {
+            //A puzzle is written like a solution, blank cells and all
+            bool hasBoard = status == RecordStatus::PUZZLE || status == RecordStatus::SOLVED;
+            writeSolution<BOX>(writer, board, hasBoard, status == RecordStatus::ABORTED, true);
+            ++count;
+        }
+    }
+    flushWriter(writer);
+    fclose(writer.file);
+    close(reader.fd);
+    cout << (cmd.pack ? "Packed " : "Unpacked ") << count << " puzzles\n";
+}
+
+/*
+Returns the name of a corpus file, without its directory and extension
+*/
+string corpusName(const string& path)
+{
+    size_t slash = path.find_last_of('/');
+    string name = slash == string::npos ? path : path.substr(slash + 1);
+    return name.substr(0, name.find('.'));
+}
+
+/*
+Runs every corpus through every configuration on 1 thread and prints a row of results for each,
+as CSV or as a JSON array
+Each corpus is run benchWarmup times without measuring, then benchRepeat times, timing every puzzle
+Puzzle i is seeded with seed + i, so the nodes and guesses are the same in every run, and the seed is
+printed in every row so the results can be reproduced with --seed
+*/
+template <size_t BOX>
+void runBench(const CommandLine& cmd)
+{
+    using S = Sudoku<BOX>;
+    vector<BenchConfig> configs;
+    parseBenchConfigs(cmd.benchConfigs, cmd.options, configs);
+    if (cmd.benchJson)
+    {
+        cout << "[\n";
+    }
+    else
+    {
+        cout << "corpus,config,seed,puzzles,repeats,solved,aborted,puzzles_per_sec,median_us,p99_us,nodes_per_puzzle,guesses_per_puzzle\n";
+    }
+    bool firstRow = true;
+    Solver<BOX> solver;
+    for (const string& path : cmd.benchCorpora)
+    {
+        PuzzleReader reader;
+        if (!openReader(reader, path))
+        {
+            cerr << "Could not open input file " << path << '\n';
+            exit(1);
+        }
+        vector<typename S::Board> puzzles(1);
+        bool lineFormat = false;
+        while (readPuzzle<BOX>(reader, puzzles.back(), lineFormat))
+        {
+            puzzles.emplace_back();
+        }
+        puzzles.pop_back();
+        close(reader.fd);
+        for (const BenchConfig& config : configs)
+        {
+            solver.setOptions(config.options);
+            vector<double> latencies;
+            latencies.reserve(puzzles.size() * cmd.benchRepeat);
+            double total = 0;
+            size_t solved = 0;
+            size_t aborted = 0;
+            size_t nodes = 0;
+            size_t guesses = 0;
+            for (size_t run = 0; run < cmd.benchWarmup + cmd.benchRepeat; ++run)
+            {
+                bool measured = run >= cmd.benchWarmup;
+                for (size_t i = 0; i < puzzles.size(); ++i)
+                {
+                    typename S::Board board = puzzles[i];
+                    solver.setSeed(cmd.seed + i);
+                    auto start = chrono::steady_clock::now();
+                    size_t found = cmd.counting ? solver.count(board.cells, config.options.solutionLimit)
+                                                : solver.solve(board.cells);
+                    double elapsed = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+                    if (measured)
+                    {
+                        latencies.push_back(elapsed);
+                        total += elapsed;
+                    }
+                    if (run == cmd.benchWarmup)
+                    {
+                        solved += (found > 0);
+                        aborted += solver.aborted();
+                        nodes += solver.stats().nodes;
+                        guesses += solver.stats().guesses;
+                    }
+                }
+            }
+            sort(latencies.begin(), latencies.end());
+            size_t count = puzzles.size();
+            double median = latencies.empty() ? 0 : latencies[latencies.size() / 2];
+            double p99 = latencies.empty() ? 0 : latencies[(latencies.size() * 99 + 99) / 100 - 1];
+            double perSec = total > 0 ? latencies.size() / (total / 1e6) : 0;
+            double perPuzzle = count > 0 ? 1.0 / count : 0;
+            string name = corpusName(path);
+            unsigned long long seed = cmd.seed;
+            char row[512];
+            if (cmd.benchJson)
+            {
+                snprintf(row, sizeof(row),
+                    "%s  {\"corpus\": \"%s\", \"config\": \"%s\", \"seed\": %llu, \"puzzles\": %zu, \"repeats\": %zu, "
+                    "\"solved\": %zu, \"aborted\": %zu, \"puzzles_per_sec\": %.1f, \"median_us\": %.2f, \"p99_us\": %.2f, "
+                    "\"nodes_per_puzzle\": %.2f, \"guesses_per_puzzle\": %.2f}",
+                    firstRow ? "" : ",\n", name.c_str(), config.name.c_str(), seed, count, cmd.benchRepeat, solved,
+                    aborted, perSec, median, p99, nodes * perPuzzle, guesses * perPuzzle);
+            }
+            else
+            {
+                snprintf(row, sizeof(row), "%s,%s,%llu,%zu,%zu,%zu,%zu,%.1f,%.2f,%.2f,%.2f,%.2f\n",
+                    name.c_str(), config.name.c_str(), seed, count, cmd.benchRepeat, solved, aborted,
+                    perSec, median, p99, nodes * perPuzzle, guesses * perPuzzle);
+            }
+            cout << row << flush;
+            firstRow = false;
+        }
+    }
+    if (cmd.benchJson)
+    {
+        cout << "\n]\n";
+    }
+}
+
+/*
+Prints how to run the program
+*/
+void printUsage(const char* program)
+{
+    cerr << "Usage: " << program << " [--propagate none|forward|ac3] [--logic off|pre|node]"
+         << " [--tiebreak random|first] [--order natural|lcv] [--backjump] [--nogoods N]"
+         << " [--engine csp|dlx] [--size 4|9|16|25] [--simd auto|off] [--seed N] [--count N]"
+         << " [--time-limit MS] [--node-limit N] [--backtrack-limit N] [--batch] [--lockstep] [--threads N] [--split N]"
+         << " [--cache] [--cache-file file] [--cache-size N] [--packed] [input] [output]\n"
+         << "       " << program << " --pack|--unpack [--size 4|9|16|25] [input] [output]\n"
+         << "       " << program << " --serve [--socket path] [options]\n"
+         << "       " << program << " --bench corpus [--bench corpus ...] [--configs list] [--repeat N] [--warmup N]"
+         << " [--format csv|json] [options]\n";
+    if (SEARCH_STATS)
+    {
+        cerr << "Solving also takes --stats file, which writes the search statistics of every puzzle to file\n";
+    }
+}
+
+/*
+Reads a number from the command line into value
+Returns false if the argument is not a number
+*/
+bool parseNumber(const string& arg, uint64_t& value)
+{
+    size_t end = 0;
+    try
+    {
+        value = stoull(arg, &end);
+    }
+    catch (const exception&)
+    {
+        return false;
+    }
+    return end != 0 && end == arg.size();
+}
+
+/*
+Reads the command line arguments into cmd
+Returns false if they are not valid
+*/
+bool parseCommandLine(int argc, char* argv[], CommandLine& cmd)
+{
+    size_t positional = 0;
+    for (int a = 1; a < argc; ++a)
+    {
+        string arg = argv[a];
+        //Every option except --batch takes a value
+        bool hasValue = a + 1 < argc;
+        if (arg == "--propagate" && hasValue)
+        {
+            string mode = argv[++a];
+            if (mode == "none")
+            {
+                cmd.options.propagation = Propagation::NONE;
+            }
+            else if (mode == "forward")
+            {
+                cmd.options.propagation = Propagation::FORWARD;
+            }
+            else if (mode == "ac3")
+            {
+                cmd.options.propagation = Propagation::AC3;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (arg == "--logic" && hasValue)
+        {
+            string mode = argv[++a];
+            if (mode == "off")
+            {
+                cmd.options.logicMode = LogicMode::OFF;
+            }
+            else if (mode == "pre")
+            {
+                cmd.options.logicMode = LogicMode::PRE;
+            }
+            else if (mode == "node")
+            {
+                cmd.options.logicMode = LogicMode::NODE;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (arg == "--tiebreak" && hasValue)
+        {
+            string mode = argv[++a];
+            if (mode == "random")
+            {
+                cmd.options.tieBreak = TieBreak::RANDOM;
+            }
+            else if (mode == "first")
+            {
+                cmd.options.tieBreak = TieBreak::FIRST;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (arg == "--order" && hasValue)
+        {
+            string order = argv[++a];
+            if (order == "natural")
+            {
+                cmd.options.valueOrder = ValueOrder::NATURAL;
+            }
+            else if (order == "lcv")
+            {
+                cmd.options.valueOrder = ValueOrder::LCV;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (arg == "--backjump")
+        {
+            cmd.options.backjump = true;
+        }
+        else if (arg == "--nogoods" && hasValue)
+        {
+            uint64_t limit = 0;
+            if (!parseNumber(argv[++a], limit))
+            {
+                return false;
+            }
+            cmd.options.backjump = true;
+            cmd.options.nogoodLimit = limit;
+        }
+        else if (arg == "--engine" && hasValue)
+        {
+            string engine = argv[++a];
+            if (engine == "csp")
+            {
+                cmd.options.engine = Engine::CSP;
+            }
+            else if (engine == "dlx")
+            {
+                cmd.options.engine = Engine::DLX;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (arg == "--size" && hasValue)
+        {
+            uint64_t size = 0;
+            if (!parseNumber(argv[++a], size))
+            {
+                return false;
+            }
+            //Boards are made of BOX x BOX grids
+            size_t box = 2;
+            while (box * box < size)
+            {
+                ++box;
+            }
+            if (box * box != size || box > 5)
+            {
+                return false;
+            }
+            cmd.box = box;
+        }
+        else if (arg == "--simd" && hasValue)
+        {
+            string mode = argv[++a];
+            if (mode == "off")
+            {
+                useAvx2 = false;
+            }
+            else if (mode != "auto")
+            {
+                return false;
+            }
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            if (!parseNumber(argv[++a], cmd.seed))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--count" && hasValue)
+        {
+            uint64_t limit = 0;
+            if (!parseNumber(argv[++a], limit))
+            {
+                return false;
+            }
+            cmd.options.solutionLimit = limit;
+            cmd.counting = true;
+        }
+        else if ((arg == "--time-limit" || arg == "--node-limit" || arg == "--backtrack-limit") && hasValue)
+        {
+            uint64_t limit = 0;
+            if (!parseNumber(argv[++a], limit))
+            {
+                return false;
+            }
+            if (arg == "--time-limit")
+            {
+                cmd.options.timeLimitMs = limit;
+            }
+            else if (arg == "--node-limit")
+            {
+                cmd.options.nodeLimit = limit;
+            }
+            else
+            {
+                cmd.options.backtrackLimit = limit;
+            }
+        }
+        else if (arg == "--split" && hasValue)
+        {
+            uint64_t depth = 0;
+            if (!parseNumber(argv[++a], depth))
+            {
+                return false;
+            }
+            cmd.splitDepth = depth;
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            uint64_t threads = 0;
+            if (!parseNumber(argv[++a], threads) || threads == 0)
+            {
+                return false;
+            }
+            cmd.threads = threads;
+        }
+        else if (arg == "--bench" && hasValue)
+        {
+            cmd.benchCorpora.push_back(argv[++a]);
+        }
+        else if (arg == "--configs" && hasValue)
+        {
+            vector<BenchConfig> configs;
+            cmd.benchConfigs = argv[++a];
+            if (!parseBenchConfigs(cmd.benchConfigs, cmd.options, configs))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--repeat" && hasValue)
+        {
+            uint64_t repeat = 0;
+            if (!parseNumber(argv[++a], repeat) || repeat == 0)
+            {
+                return false;
+            }
+            cmd.benchRepeat = repeat;
+        }
+        else if (arg == "--warmup" && hasValue)
+        {
+            uint64_t warmup = 0;
+            if (!parseNumber(argv[++a], warmup))
+            {
+                return false;
+            }
+            cmd.benchWarmup = warmup;
+        }
+        else if (arg == "--format" && hasValue)
+        {
+            string format = argv[++a];
+            if (format != "csv" && format != "json")
+            {
+                return false;
+            }
+            cmd.benchJson = format == "json";
+        }
+        else if (arg == "--stats" && hasValue && SEARCH_STATS)
+        {
+            cmd.statsFile = argv[++a];
+        }
+        else if (arg == "--batch")
+        {
+            cmd.batch = true;
+        }
+        else if (arg == "--lockstep")
+        {
+            cmd.lockstep = true;
+        }
+        else if (arg == "--cache")
+        {
+            cmd.cache = true;
+        }
+        else if (arg == "--cache-file" && hasValue)
+        {
+            cmd.cache = true;
+            cmd.cacheFile = argv[++a];
+        }
+        else if (arg == "--cache-size" && hasValue)
+        {
+            uint64_t size = 0;
+            if (!parseNumber(argv[++a], size))
+            {
+                return false;
+            }
+            cmd.cache = true;
+            cmd.cacheSize = size;
+        }
+        else if (arg == "--packed")
+        {
+            cmd.packed = true;
+        }
+        else if (arg == "--pack")
+        {
+            cmd.pack = true;
+        }
+        else if (arg == "--unpack")
+        {
+            cmd.unpack = true;
+        }
+        else if (arg == "--serve")
+        {
+            cmd.serve = true;
+        }
+        else if (arg == "--socket" && hasValue)
+        {
+            cmd.serve = true;
+            cmd.socketPath = argv[++a];
+        }
+        else if (arg.size() > 1 && arg[0] == '-')
+        {
+            return false;
+        }
+        else if (positional == 0)
+        {
+            cmd.input = arg;
+            ++positional;
+        }
+        else if (positional == 1)
+        {
+            cmd.output = arg;
+            ++positional;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    //The cache holds solutions of 9x9 puzzles solved in batch or server mode, and only the backtracking search is split
+    return (!cmd.cache || ((cmd.batch || cmd.serve) && cmd.box == 3 && !cmd.counting)) &&
+           (cmd.splitDepth == 0 || (!cmd.batch && !cmd.serve && cmd.options.engine == Engine::CSP)) &&
+           (!cmd.serve || (!cmd.batch && cmd.benchCorpora.empty())) &&
+           (!cmd.packed || (cmd.batch && !cmd.counting)) &&
+           (!cmd.lockstep || cmd.batch) &&
+           (!(cmd.pack || cmd.unpack) || (cmd.pack != cmd.unpack && !cmd.batch && !cmd.serve && cmd.benchCorpora.empty()));
+}
+
+/*
+Searches the puzzle in ctx, set up by prepareSearch, on a pool of threads, like backtrack
+The nodes at depth splitDepth of the search tree are left as subproblems, which the workers search on their own
+Every worker stops once ctx.options.solutionLimit solutions have been found between them
+The node and backtrack budgets apply to each subproblem, and the time budget to the whole search
+The solutions, the first of them, the search statistics and the budgets used by the subproblems are added up in ctx
+*/
+template <size_t BOX>
+void searchParallel(typename Sudoku<BOX>::SearchContext& ctx, size_t splitDepth, size_t threads, uint64_t seed)
+{
+    using S = Sudoku<BOX>;
+    vector<typename S::Board> subproblems;
+    ctx.subproblems = &subproblems;
+    ctx.splitDepth = splitDepth;
+    //Solutions above the split depth are found and counted as usual
+    S::backtrack(ctx);
+    ctx.subproblems = nullptr;
+    const size_t limit = ctx.options.solutionLimit;
+    if (ctx.aborted || (limit != 0 && ctx.solutions >= limit) || subproblems.empty())
+    {
+        return;
+    }
+    //On stderr, which keeps it out of the results
+    cerr << "Subproblems: " << subproblems.size() << '\n';
+
+    WorkerPool pool;
+    startPool(pool, threads);
+    vector<unique_ptr<typename S::SearchContext>> contexts(pool.workers);
+    atomic<bool> cancel(false);
+    //Guards ctx while a worker adds the results of its subproblem
+    mutex lock;
+    bool aborted = false;
+    runJobs(pool, subproblems.size(), [&](size_t worker, size_t job)
+    {
+        if (cancel.load(memory_order_relaxed))
+        {
+            return;
+        }
+        if (!contexts[worker])
+        {
+            contexts[worker] = make_unique<typename S::SearchContext>();
+        }
+        typename S::SearchContext& sub = *contexts[worker];
+        sub.options = ctx.options;
+        sub.board = subproblems[job];
+        sub.rngState = seed + job;
+        sub.cancel = &cancel;
+        sub.deadline = ctx.deadline;
+        S::searchSubproblem(sub);
+        lock_guard<mutex> guard(lock);
+        if (ctx.solutions == 0 && sub.solutions > 0)
+        {
+            ctx.solution = sub.solution;
+        }
+        ctx.solutions += sub.solutions;
+        aborted = aborted || sub.aborted;
+        ctx.budgetNodes += sub.budgetNodes;
+        ctx.budgetBacktracks += sub.budgetBacktracks;
+        SearchStats& stats = ctx.stats;
+        stats.nodes += sub.stats.nodes;
+        stats.guesses += sub.stats.guesses;
+        stats.backtracks += sub.stats.backtracks;
+        stats.propagations += sub.stats.propagations;
+        stats.mrvDecisions += sub.stats.mrvDecisions;
+        stats.degreeDecisions += sub.stats.degreeDecisions;
+        stats.tieBreaks += sub.stats.tieBreaks;
+        stats.maxDepth = max(stats.maxDepth, splitDepth + sub.stats.maxDepth);
+        if (limit != 0 && ctx.solutions >= limit)
+        {
+            cancel.store(true, memory_order_relaxed);
+        }
+    });
+    stopPool(pool);
+    //Subproblems that were still running when the limit was reached may have added more
+    if (limit != 0 && ctx.solutions >= limit)
+    {
+        ctx.solutions = limit;
+    }
+    else
+    {
+        ctx.aborted = aborted;
+    }
+}
+
+/*
+Solves the single puzzle of the input file, printing the steps, and writes its solution to the output file
+A puzzle without a solution, or whose search ran out of budget, is written out unchanged, blank cells and all
+*/
+template <size_t BOX>
+void runSingle(const CommandLine& cmd)
+{
+    using S = Sudoku<BOX>;
+    const size_t SIZE = S::SIZE;
+    const size_t CELLS = S::CELLS;
+
+    //Set up the search, with every cell of the board unassigned
+    typename S::SearchContext ctx;
+    ctx.board = typename S::Board{};
+    ctx.options = cmd.options;
+    typename S::Board& board = ctx.board;
+
+    /*
+    Read the board state from the input file
+    */
+    ifstream ifs;
+    ifs.open(cmd.input);
+    if (!ifs)
+    {
+        cerr << "Could not open input file\n";
+        exit(1);
+    }
+    string line{};
+    size_t cell = 0;
+    while (ifs >> line)
+    {
+        if (cell == CELLS)
+        {
+            cerr << "Error: board overflow\n";
+            exit(2);
+        }
+        if (!S::parseCell(line.data(), line.size(), board.cells[cell]))
+        {
+            cerr << "Error: invalid cell value " << line << '\n';
+            exit(4);
+        }
+        ++cell;
+    }
+    ifs.close();
+    ifs.clear();
+    //The search leaves its guesses on the board, so a puzzle it does not solve is written back as it was given
+    const typename S::Board puzzle = board;
+
+    ctx.rngState = cmd.seed;
+    bool csp = ctx.options.engine == Engine::CSP;
+    if (usesSeed(ctx.options))
+    {//Print the seed so the run can be reproduced with --seed
+        cout << "Seed: " << cmd.seed << '\n';
+    }
+
+    bool result = true;
+    if (csp)
+    {
+        //Construct the domain of each variable and deduce what can be deduced before searching
+        result = S::prepareSearch(ctx);
+        if (result && ctx.options.logicMode != LogicMode::OFF)
+        {
+            size_t left = 0;
+            for (size_t i = 0; i < CELLS; ++i)
+            {
+                left += (board.cells[i] == 0);
+            }
+            cout << "Cells left for the search after logic: " << left << '\n';
+        }
+    }
+
+    if (!csp)
+    {//Solve Sudoku puzzle as an exact cover problem
+        cout << "\nDancing Links\n";
+        S::solveDlx(ctx);
+    }
+    else
+    {//Use backtracking to solve Sudoku puzzle
+        cout << "\nBacktracking\n";
+        if (result && cmd.splitDepth > 0)
+        {
+            searchParallel<BOX>(ctx, cmd.splitDepth, cmd.threads, cmd.seed);
+        }
+        else if (result)
+        {
+            S::backtrack(ctx);
+        }
+    }
+    result = ctx.solutions > 0;
+    board = result ? ctx.solution : puzzle;
+    cout << "Result: " << std::boolalpha << result << '\n';
+    if (ctx.aborted)
+    {
+        cout << "Aborted: the search ran out of budget after " << ctx.budgetNodes << " nodes and "
+             << ctx.budgetBacktracks << " backtracks\n";
+    }
+    if (cmd.counting)
+    {
+        cout << "Solutions: " << ctx.solutions;
+        if (ctx.aborted)
+        {//The search stopped early, so there may be more
+            cout << " (aborted)";
+        }
+        else if (ctx.options.solutionLimit != 0 && ctx.solutions == ctx.options.solutionLimit)
+        {//The search stopped at the limit, so there may be more
+            cout << " (limit reached)";
+        }
+        cout << '\n';
+    }
+    printBoard<BOX>(board);
+    if (csp && ctx.options.logicMode != LogicMode::OFF)
+    {
+        printLogicStats(ctx.logic);
+    }
+    if (!cmd.statsFile.empty())
+    {
+        SolutionWriter statsWriter;
+        openStats(statsWriter, cmd.statsFile);
+        writeStats(statsWriter, 0, cmd.seed, ctx.solutions, ctx.aborted, ctx.stats);
+        flushWriter(statsWriter);
+        fclose(statsWriter.file);
+    }
+
+    //Output results to an output file
+    ofstream ofs(cmd.output);
+    if (!ofs)
+    {
+        cerr << "Could not open output file\n";
+        exit(3);
+    }
+    for (size_t i = 0; i < SIZE; ++i)
+    {
+        line = "";
+        for (size_t j = 0; j < SIZE; ++j)
+        {
+            if (j != 0)
+            {
+                line += ' ';
+            }
+            line += to_string(board.cells[i * SIZE + j]);
+        }
+        line += "\n";
+        //Add the line to output file
+        ofs << line;
+    }
+    ofs.close();
+}
+
+/*
+Runs the mode chosen on the command line with the solver for boards of BOX x BOX grids
+*/
+template <size_t BOX>
+void run(const CommandLine& cmd)
+{
+    if (!cmd.benchCorpora.empty())
+    {
+        runBench<BOX>(cmd);
+    }
+    else if (cmd.pack || cmd.unpack)
+    {
+        runConvert<BOX>(cmd);
+    }
+    else if (cmd.batch)
+    {
+        runBatch<BOX>(cmd);
+    }
+    else if (cmd.serve)
+    {
+        runServer<BOX>(cmd);
+    }
+    else
+    {
+        runSingle<BOX>(cmd);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    CommandLine cmd;
+    if (!parseCommandLine(argc, argv, cmd))
+    {
+        printUsage(argv[0]);
+        exit(5);
+    }
+    //Every board size has its own solver, generated at compile time
+    switch (cmd.box)
+    {
+    case 2:
+        run<2>(cmd);
+        break;
+    case 3:
+        run<3>(cmd);
+        break;
+    case 4:
+        run<4>(cmd);
+        break;
+    default:
+        run<5>(cmd);
+        break;
+    }
+    return 0;
+}
@@ -0,0 +1,2919 @@
+/*
+Sudoku Solver Using AI
+Solver library: the board representation, the search engines and the Solver object for other programs
+Everything is in namespace sudoku; the program in sudoku.cpp is built on it
+*/
+
+#ifndef SUDOKU_H
+#define SUDOKU_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>//For the time budget
+#include <algorithm>
+#include <memory>
+#include <atomic>
+#include <type_traits>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <list>
+#include <string_view>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>//For the AVX2 kernels
+#define HAVE_AVX2_KERNELS 1
+#endif
+
+namespace sudoku
+{
+
+/*
+Constraint propagation done after each assignment
+NONE only narrows the domain of the assigned cell
+FORWARD removes the assigned digit from the domains of the cell's peers (forward checking)
+AC3 keeps all the row, column and grid constraints arc consistent: whenever a domain
+is narrowed down to 1 value, that value is also removed from the domains of its peers
+*/
+enum class Propagation { NONE, FORWARD, AC3 };
+
+/*
+When the logic rules (see applyLogic) are run
+OFF never runs them
+PRE runs them once on the puzzle before the search
+NODE also runs them at every node of the search
+*/
+enum class LogicMode { OFF, PRE, NODE };
+
+/*
+Number of times each logic rule made progress
+A single is counted per placed digit, the other rules per unit or line they narrowed
+*/
+struct LogicStats
+{
+    size_t nakedSingles = 0;
+    size_t hiddenSingles = 0;
+    size_t nakedPairs = 0;
+    size_t nakedTriples = 0;
+    size_t hiddenPairs = 0;
+    size_t hiddenTriples = 0;
+    size_t pointing = 0;
+    size_t boxLine = 0;
+};
+
+/*
+Search counters are compiled in when SEARCH_STATS is 1, the default
+Building with -DSEARCH_STATS=0 leaves them out, so counting costs nothing
+COUNT_STAT wraps every statement that updates a counter
+*/
+#ifndef SEARCH_STATS
+#define SEARCH_STATS 1
+#endif
+#if SEARCH_STATS
+#define COUNT_STAT(statement) statement
+#else
+#define COUNT_STAT(statement)
+#endif
+
+/*
+Counters of the work done by 1 search, for finding out which puzzles are expensive and why
+*/
+struct SearchStats
+{
+    //Nodes of the search entered, and how many of them had more than 1 value to try
+    size_t nodes = 0;
+    size_t guesses = 0;
+    //Values assigned and then undone
+    size_t backtracks = 0;
+    //Cells whose value was removed from their peers
+    size_t propagations = 0;
+    //Cells to branch on chosen by MRV alone, and by the degree heuristic among cells tied on MRV
+    size_t mrvDecisions = 0;
+    size_t degreeDecisions = 0;
+    //Degree heuristic choices that were tied and settled by the tie-break rule
+    size_t tieBreaks = 0;
+    //Most cells assigned by the search at once, not counting the ones before it started
+    size_t maxDepth = 0;
+};
+
+/*
+How the degree heuristic breaks ties between cells
+RANDOM picks one of the tied cells with the search's random number generator
+FIRST picks the tied cell that comes first on the board, which makes every run the same
+*/
+enum class TieBreak { RANDOM, FIRST };
+
+/*
+Order the values of the cell chosen by the search are tried in
+NATURAL tries them from the lowest digit up
+LCV tries first the least constraining value: the one that rules out the fewest candidates of the cell's peers
+*/
+enum class ValueOrder { NATURAL, LCV };
+
+/*
+Engine that searches for the solutions
+CSP is the backtracking search with the heuristics, propagation and logic rules above
+DLX solves the puzzle as an exact cover problem with Dancing Links (Algorithm X)
+*/
+enum class Engine { CSP, DLX };
+
+/*
+Settings of the search, chosen on the command line or by the program using the library
+*/
+struct SolveOptions
+{
+    Propagation propagation = Propagation::AC3;
+    LogicMode logicMode = LogicMode::PRE;
+    TieBreak tieBreak = TieBreak::RANDOM;
+    ValueOrder valueOrder = ValueOrder::NATURAL;
+    Engine engine = Engine::CSP;
+    //The search stops once this many solutions are found, 0 for no limit
+    //1 solves the puzzle, 2 is enough to check that its solution is unique
+    size_t solutionLimit = 1;
+    //Budgets of 1 solve, 0 for no limit: a solve that runs out of one stops early and is aborted
+    uint64_t timeLimitMs = 0;
+    size_t nodeLimit = 0;
+    size_t backtrackLimit = 0;
+    //Jump back over the levels of the search that had no part in a dead end, see jumpBack
+    bool backjump = false;
+    //Most nogoods kept by the backjumping search, 0 to keep none, see recordNogood
+    size_t nogoodLimit = 0;
+};
+
+/*
+The clock is only read every this many nodes, which keeps the time budget cheap to check
+*/
+const size_t TIME_CHECK_NODES = 64;
+
+/*
+Returns true if the CPU running the program supports AVX2
+*/
+bool cpuHasAvx2();
+
+/*
+Whether the SIMD kernels are used instead of their scalar versions
+They are only used if the CPU has AVX2, which is checked once at startup, unless this is set to false
+*/
+extern bool useAvx2;
+
+/*
+Solver for boards of any size, generated at compile time for each box width
+BOX is the width of one of the grids: 2 for 4x4 boards, 3 for 9x9, 4 for 16x16 and 5 for 25x25
+Every size gets its own masks, tables and loop bounds, so the common 9x9 case pays nothing for the others
+*/
+template <size_t BOX>
+struct Sudoku
+{
+    /*
+    Dimensions of the board
+    */
+    static constexpr size_t SIZE = BOX * BOX;
+    static constexpr size_t CELLS = SIZE * SIZE;
+
+    /*
+    Digits are stored in masks with bit d-1 set for digit d
+    Mask is the smallest type with a bit per digit, and Index the smallest type that holds a cell
+    ALL_DIGITS is the mask with every digit set
+    */
+    using Mask = typename std::conditional<(SIZE <= 16), uint16_t, uint32_t>::type;
+    using Index = typename std::conditional<(CELLS <= 256), uint8_t, uint16_t>::type;
+    static constexpr Mask ALL_DIGITS = static_cast<Mask>((1u << SIZE) - 1);
+
+    /*
+    The SIMD kernels hold 16 masks of 16 bits in a vector, so they are used for boards up to 16x16
+    The cells and domains of the board are padded so a full vector can be loaded at any row
+    */
+    static constexpr bool VECTOR = SIZE <= 16;
+    static constexpr size_t PADDED_CELLS = (CELLS + 31) / 32 * 32;
+
+    /*
+    Compact representation of the board that the search runs on
+    cells holds the digit in each cell, row by row, 0 if the cell is unassigned
+    rowUsed, colUsed and gridUsed are masks of the digits placed in each row, column and grid
+    cand holds the domain (legal values) of each cell as a mask
+    The whole board is a few hundred bytes, so it is cheap to copy
+    */
+    struct Board
+    {
+        alignas(32) uint8_t cells[PADDED_CELLS];
+        Mask rowUsed[SIZE];
+        Mask colUsed[SIZE];
+        Mask gridUsed[SIZE];
+        alignas(32) Mask cand[PADDED_CELLS];
+    };
+
+    /*
+    Returns the row, column and grid of a cell index
+    Grids are numbered row by row, starting at the top left
+    */
+    static constexpr size_t rowOf(size_t cell)
+    {
+        return cell / SIZE;
+    }
+
+    static constexpr size_t colOf(size_t cell)
+    {
+        return cell % SIZE;
+    }
+
+    static constexpr size_t gridOf(size_t cell)
+    {
+        return (rowOf(cell) / BOX) * BOX + colOf(cell) / BOX;
+    }
+
+    /*
+    Returns the mask with only the bit of digit d set
+    */
+    static inline Mask digitBit(size_t d)
+    {
+        return static_cast<Mask>(1u << (d - 1));
+    }
+
+    /*
+    Returns the lowest digit in a non-empty mask
+    */
+    static inline uint8_t lowestDigit(Mask mask)
+    {
+        return static_cast<uint8_t>(__builtin_ctz(mask) + 1);
+    }
+
+    /*
+    Returns how many digits are in a mask
+    */
+    static inline size_t countDigits(Mask mask)
+    {
+        return static_cast<size_t>(__builtin_popcount(mask));
+    }
+
+    /*
+    Converts a token of the input file to the digit of a cell
+    Returns false if the token is not a number from 0 to SIZE
+    */
+    static bool parseCell(const char* token, size_t length, uint8_t& digit)
+    {
+        if (length == 0 || length > 2)
+        {
+            return false;
+        }
+        size_t value = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (token[i] < '0' || token[i] > '9')
+            {
+                return false;
+            }
+            value = value * 10 + static_cast<size_t>(token[i] - '0');
+        }
+        if (value > SIZE)
+        {
+            return false;
+        }
+        digit = static_cast<uint8_t>(value);
+        return true;
+    }
+
+    /*
+    Places digit into an unassigned cell and marks it as used in the cell's row, column and grid
+    */
+    static void placeDigit(Board& board, size_t cell, uint8_t digit)
+    {
+        Mask bit = digitBit(digit);
+        board.cells[cell] = digit;
+        board.rowUsed[rowOf(cell)] |= bit;
+        board.colUsed[colOf(cell)] |= bit;
+        board.gridUsed[gridOf(cell)] |= bit;
+    }
+
+    /*
+    Undoes placeDigit, leaving the cell unassigned
+    */
+    static void removeDigit(Board& board, size_t cell)
+    {
+        Mask bit = digitBit(board.cells[cell]);
+        board.cells[cell] = 0;
+        board.rowUsed[rowOf(cell)] &= ~bit;
+        board.colUsed[colOf(cell)] &= ~bit;
+        board.gridUsed[gridOf(cell)] &= ~bit;
+    }
+
+    /*
+    Fills out the initial legal values for the domain of 1 variable
+    0 has every digit
+    Else the domain is specified to the number that's already there
+    */
+    static void constructDomVar(uint8_t var, Mask& domain)
+    {
+        if (var == 0)
+        {
+            domain = ALL_DIGITS;
+        }
+        else
+        {
+            domain = digitBit(var);
+        }
+    }
+
+    /*
+    Fills out the initial legal values for the domain of the variables
+    and the used masks of the rows, columns and grids from the digits already on the board
+    0 has every digit
+    Else the domain is specified to the number that's already there
+    */
+    static void constructDom(Board& board)
+    {
+        for (size_t i = 0; i < SIZE; ++i)
+        {
+            board.rowUsed[i] = 0;
+            board.colUsed[i] = 0;
+            board.gridUsed[i] = 0;
+        }
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            uint8_t digit = board.cells[cell];
+            if (digit != 0)
+            {
+                placeDigit(board, cell, digit);
+            }
+            constructDomVar(digit, board.cand[cell]);
+        }
+    }
+
+    /*
+    Checks to see if complete assignment of board
+    Input: the board
+    */
+    static bool isCompleteBoard(const Board& board)
+    {
+#ifdef HAVE_AVX2_KERNELS
+        if constexpr (VECTOR)
+        {
+            if (useAvx2)
+            {
+                return isCompleteBoardAvx2(board);
+            }
+        }
+#endif
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            if (board.cells[cell] == 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+    Set of cells of the board, with 1 bit per cell
+    */
+    static constexpr size_t CELL_WORDS = (CELLS + 63) / 64;
+
+    struct CellSet
+    {
+        uint64_t words[CELL_WORDS];
+    };
+
+    /*
+    Adds or removes a cell from a set, and checks whether a cell is in it
+    */
+    static constexpr void addCell(CellSet& set, size_t cell)
+    {
+        set.words[cell / 64] |= uint64_t(1) << (cell % 64);
+    }
+
+    static inline void removeCell(CellSet& set, size_t cell)
+    {
+        set.words[cell / 64] &= ~(uint64_t(1) << (cell % 64));
+    }
+
+    static inline bool hasCell(const CellSet& set, size_t cell)
+    {
+        return (set.words[cell / 64] >> (cell % 64)) & 1;
+    }
+
+    /*
+    Returns how many cells are in a set
+    */
+    static inline size_t countCells(const CellSet& set)
+    {
+        size_t count = 0;
+        for (size_t w = 0; w < CELL_WORDS; ++w)
+        {
+            count += static_cast<size_t>(__builtin_popcountll(set.words[w]));
+        }
+        return count;
+    }
+
+    /*
+    Returns the lowest cell in a set, or CELLS if the set is empty
+    */
+    static inline size_t firstCell(const CellSet& set)
+    {
+        for (size_t w = 0; w < CELL_WORDS; ++w)
+        {
+            if (set.words[w] != 0)
+            {
+                return w * 64 + static_cast<size_t>(__builtin_ctzll(set.words[w]));
+            }
+        }
+        return CELLS;
+    }
+
+    /*
+    Returns the highest cell in a set, or CELLS if the set is empty
+    */
+    static inline size_t lastCell(const CellSet& set)
+    {
+        for (size_t w = CELL_WORDS; w-- > 0;)
+        {
+            if (set.words[w] != 0)
+            {
+                return w * 64 + 63 - static_cast<size_t>(__builtin_clzll(set.words[w]));
+            }
+        }
+        return CELLS;
+    }
+
+    /*
+    Returns the lowest cell in a set that comes after cell, or CELLS if there is none
+    Used to loop over a set: for (c = firstCell(set); c < CELLS; c = nextCell(set, c))
+    */
+    static inline size_t nextCell(const CellSet& set, size_t cell)
+    {
+        ++cell;
+        size_t w = cell / 64;
+        if (w >= CELL_WORDS)
+        {
+            return CELLS;
+        }
+        uint64_t bits = set.words[w] & (~uint64_t(0) << (cell % 64));
+        while (bits == 0)
+        {
+            if (++w == CELL_WORDS)
+            {
+                return CELLS;
+            }
+            bits = set.words[w];
+        }
+        return w * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+    }
+
+    /*
+    Number of units (rows, columns and grids) on the board
+    and number of peers of each cell, the other cells sharing a unit with it
+    */
+    static constexpr size_t UNITS = 3 * SIZE;
+    static constexpr size_t PEERS = 2 * (SIZE - 1) + (BOX - 1) * (BOX - 1);
+
+    /*
+    Computes the k-th cell of unit u
+    Units 0 to SIZE - 1 are the rows, then come the columns and then the grids
+    */
+    static constexpr size_t computeUnitCell(size_t u, size_t k)
+    {
+        if (u < SIZE)
+        {
+            return u * SIZE + k;
+        }
+        if (u < 2 * SIZE)
+        {
+            return k * SIZE + (u - SIZE);
+        }
+        size_t g = u - 2 * SIZE;
+        return ((g / BOX) * BOX + k / BOX) * SIZE + (g % BOX) * BOX + k % BOX;
+    }
+
+    /*
+    Lookup tables of the board layout, computed at compile time
+    units lists the cells of each unit
+    peers lists the peers of each cell, and peerSets holds them as a set
+    */
+    struct BoardTables
+    {
+        Index units[UNITS][SIZE];
+        Index peers[CELLS][PEERS];
+        CellSet peerSets[CELLS];
+    };
+
+    static constexpr BoardTables buildTables()
+    {
+        BoardTables tables{};
+        for (size_t u = 0; u < UNITS; ++u)
+        {
+            for (size_t k = 0; k < SIZE; ++k)
+            {
+                tables.units[u][k] = static_cast<Index>(computeUnitCell(u, k));
+            }
+        }
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            size_t count = 0;
+            for (size_t other = 0; other < CELLS; ++other)
+            {
+                if (other != cell && (rowOf(other) == rowOf(cell) || colOf(other) == colOf(cell) ||
+                    gridOf(other) == gridOf(cell)))
+                {
+                    tables.peers[cell][count++] = static_cast<Index>(other);
+                    addCell(tables.peerSets[cell], other);
+                }
+            }
+        }
+        return tables;
+    }
+
+    static constexpr BoardTables TABLES = buildTables();
+
+    /*
+    Returns the k-th cell of unit u
+    */
+    static inline size_t unitCell(size_t u, size_t k)
+    {
+        return TABLES.units[u][k];
+    }
+
+#ifdef HAVE_AVX2_KERNELS
+    /*
+    Shifts the 16 bit lanes of x down by K lanes, towards lane 0, filling in zeros
+    */
+    template <int K>
+    __attribute__((target("avx2"))) static inline __m256i shiftLanes(__m256i x)
+    {
+        //The upper half of x moved down, with zeros above it
+        __m256i high = _mm256_permute2x128_si256(x, x, 0x81);
+        if constexpr (K == 8)
+        {
+            return high;
+        }
+        else
+        {
+            return _mm256_alignr_epi8(high, x, 2 * K);
+        }
+    }
+
+    /*
+    Adds the unions xOnce and xTwice of other masks to the unions once and twice, lane by lane
+    */
+    __attribute__((target("avx2"))) static inline void addUnion(__m256i& once, __m256i& twice, __m256i xOnce, __m256i xTwice)
+    {
+        twice = _mm256_or_si256(_mm256_or_si256(twice, xTwice), _mm256_and_si256(once, xOnce));
+        once = _mm256_or_si256(once, xOnce);
+    }
+
+    /*
+    Adds the unions K lanes above each lane to it
+    */
+    template <int K>
+    __attribute__((target("avx2"))) static inline void foldLanes(__m256i& once, __m256i& twice)
+    {
+        addUnion(once, twice, shiftLanes<K>(once), shiftLanes<K>(twice));
+    }
+
+    /*
+    Computes the unions of the masks of every unit, numbered as in computeUnitCell
+    once[u] has the bits set in at least 1 cell of unit u, and twice[u] the bits set in at least 2
+    masks must be padded like the domains of a board
+    Each row is loaded as 1 vector: columns are unions of the rows lane by lane, rows fold
+    their lanes down to lane 0, and grids fold groups of BOX lanes of the unions of a band of rows
+    There is no scalar version, the scalar code computes the unit it needs on its own
+    */
+    __attribute__((target("avx2"))) static void unitUnions(const Mask* masks, Mask* once, Mask* twice)
+    {
+        const __m256i valid = _mm256_cmpgt_epi16(_mm256_set1_epi16(SIZE),
+            _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        __m256i colOnce = _mm256_setzero_si256();
+        __m256i colTwice = _mm256_setzero_si256();
+        __m256i bandOnce = _mm256_setzero_si256();
+        __m256i bandTwice = _mm256_setzero_si256();
+        alignas(32) uint16_t lanes[2][16];
+        for (size_t r = 0; r < SIZE; ++r)
+        {
+            __m256i row = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + r * SIZE)), valid);
+            addUnion(colOnce, colTwice, row, _mm256_setzero_si256());
+            addUnion(bandOnce, bandTwice, row, _mm256_setzero_si256());
+            __m256i rowOnce = row;
+            __m256i rowTwice = _mm256_setzero_si256();
+            foldLanes<1>(rowOnce, rowTwice);
+            if constexpr (SIZE > 2)
+            {
+                foldLanes<2>(rowOnce, rowTwice);
+            }
+            if constexpr (SIZE > 4)
+            {
+                foldLanes<4>(rowOnce, rowTwice);
+            }
+            if constexpr (SIZE > 8)
+            {
+                foldLanes<8>(rowOnce, rowTwice);
+            }
+            once[r] = static_cast<Mask>(_mm256_extract_epi16(rowOnce, 0));
+            twice[r] = static_cast<Mask>(_mm256_extract_epi16(rowTwice, 0));
+            if (r % BOX == BOX - 1)
+            {//Last row of a band, lane g * BOX ends up with the unions of its grid g
+                __m256i gridOnce = bandOnce;
+                __m256i gridTwice = bandTwice;
+                addUnion(gridOnce, gridTwice, shiftLanes<1>(bandOnce), shiftLanes<1>(bandTwice));
+                if constexpr (BOX > 2)
+                {
+                    addUnion(gridOnce, gridTwice, shiftLanes<2>(bandOnce), shiftLanes<2>(bandTwice));
+                }
+                if constexpr (BOX > 3)
+                {
+                    addUnion(gridOnce, gridTwice, shiftLanes<3>(bandOnce), shiftLanes<3>(bandTwice));
+                }
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[0]), gridOnce);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[1]), gridTwice);
+                for (size_t g = 0; g < BOX; ++g)
+                {
+                    once[2 * SIZE + r - BOX + 1 + g] = lanes[0][g * BOX];
+                    twice[2 * SIZE + r - BOX + 1 + g] = lanes[1][g * BOX];
+                }
+                bandOnce = _mm256_setzero_si256();
+                bandTwice = _mm256_setzero_si256();
+            }
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[0]), colOnce);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[1]), colTwice);
+        for (size_t c = 0; c < SIZE; ++c)
+        {
+            once[SIZE + c] = lanes[0][c];
+            twice[SIZE + c] = lanes[1][c];
+        }
+    }
+
+    /*
+    Writes the mask of the digit placed in every cell of the board to placed, 0 for a blank cell,
+    16 cells at a time: the digit less 1 picks the low and the high byte of its bit from 2 tables,
+    and a blank cell, which wraps around to 255, picks 0 from both
+    placed must be padded like the domains of a board
+    */
+    __attribute__((target("avx2"))) static void placedMasks(const Board& board, Mask* placed)
+    {
+        const __m128i one = _mm_set1_epi8(1);
+        const __m128i lowBytes = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i highBytes = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 8, 16, 32, 64, -128);
+        for (size_t i = 0; i < PADDED_CELLS; i += 16)
+        {
+            __m128i index = _mm_sub_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(board.cells + i)), one);
+            __m128i low = _mm_shuffle_epi8(lowBytes, index);
+            __m128i high = _mm_shuffle_epi8(highBytes, index);
+            _mm_store_si128(reinterpret_cast<__m128i*>(placed + i), _mm_unpacklo_epi8(low, high));
+            _mm_store_si128(reinterpret_cast<__m128i*>(placed + i + 8), _mm_unpackhi_epi8(low, high));
+        }
+    }
+
+    /*
+    AVX2 version of isCompleteBoard, 32 cells at a time
+    */
+    __attribute__((target("avx2"))) static bool isCompleteBoardAvx2(const Board& board)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        for (size_t i = 0; i < CELLS; i += 32)
+        {
+            __m256i digits = _mm256_load_si256(reinterpret_cast<const __m256i*>(board.cells + i));
+            uint32_t empty = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(digits, zero)));
+            if (CELLS - i < 32)
+            {//Leave out the padding
+                empty &= (1u << (CELLS - i)) - 1;
+            }
+            if (empty != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+#endif
+
+    /*
+    Lockstep propagation, for batch mode
+    A group holds the domains of LANES puzzles laid out cell by cell: the domains of a cell in every
+    puzzle of the group are next to each other, so the AVX2 kernel narrows the same cell of 16 puzzles
+    with each instruction
+    Naked and hidden singles are applied to every puzzle of the group at once until neither makes progress
+    in any of them, and the puzzles they do not settle are left for the search
+    */
+    static constexpr size_t LANES = 16;
+
+    /*
+    What lockstep propagation made of the puzzle in a lane: solved, shown to have no solution,
+    or left open with cells that need a guess
+    */
+    enum class LaneStatus : uint8_t
+    {
+        SOLVED,
+        NO_SOLUTION,
+        OPEN
+    };
+
+    struct LockstepGroup
+    {
+        alignas(32) Mask cand[CELLS][LANES];
+        LaneStatus status[LANES];
+    };
+
+    /*
+    Puts the puzzle in cells in a lane of the group, or leaves the lane empty if cells is null
+    An empty lane has no values left, so it ends up with no solution
+    */
+    static void setLane(LockstepGroup& group, size_t lane, const uint8_t* cells)
+    {
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            Mask domain = 0;
+            if (cells != nullptr)
+            {
+                domain = cells[cell] != 0 ? digitBit(cells[cell]) : ALL_DIGITS;
+            }
+            group.cand[cell][lane] = domain;
+        }
+    }
+
+    /*
+    Writes the digits settled in a lane of the group over cells, leaving its other cells as they are
+    */
+    static void getLane(const LockstepGroup& group, size_t lane, uint8_t* cells)
+    {
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            Mask domain = group.cand[cell][lane];
+            if (domain != 0 && (domain & (domain - 1)) == 0)
+            {
+                cells[cell] = lowestDigit(domain);
+            }
+        }
+    }
+
+    /*
+    Applies naked and hidden singles to 1 lane of the group until neither makes progress
+    A domain with 1 value is a placed digit, removed from the other cells of its units,
+    and a digit that fits in only 1 cell of a unit goes in that cell
+    Returns false if the puzzle has no solution
+    */
+    static bool propagateLane(LockstepGroup& group, size_t lane)
+    {
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (size_t u = 0; u < UNITS; ++u)
+            {
+                //Digits placed in the unit, and digits legal in at least 1 and in at least 2 of its cells
+                Mask placed = 0;
+                Mask once = 0;
+                Mask twice = 0;
+                for (size_t k = 0; k < SIZE; ++k)
+                {
+                    Mask domain = group.cand[unitCell(u, k)][lane];
+                    if (domain == 0)
+                    {
+                        return false;
+                    }
+                    if ((domain & (domain - 1)) == 0)
+                    {
+                        if ((placed & domain) != 0)
+                        {//The same digit placed twice
+                            return false;
+                        }
+                        placed |= domain;
+                    }
+                    twice |= once & domain;
+                    once |= domain;
+                }
+                if (once != ALL_DIGITS)
+                {//A digit has nowhere to go in this unit
+                    return false;
+                }
+                Mask hidden = once & ~twice & ~placed;
+                for (size_t k = 0; k < SIZE; ++k)
+                {
+                    Mask& domain = group.cand[unitCell(u, k)][lane];
+                    if ((domain & (domain - 1)) == 0)
+                    {
+                        continue;
+                    }
+                    Mask narrowed = domain & ~placed;
+                    if ((narrowed & hidden) != 0)
+                    {
+                        narrowed &= hidden;
+                    }
+                    if (narrowed == 0)
+                    {
+                        return false;
+                    }
+                    if (narrowed != domain)
+                    {
+                        domain = narrowed;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+#ifdef HAVE_AVX2_KERNELS
+    /*
+    AVX2 version of propagateLockstep, with the domains of a cell in the 16 puzzles of the group in 1 vector
+    It runs the same passes over the units as propagateLane on every lane at once; a lane found to have
+    no solution is marked dead and no longer keeps the others going, and the passes stop once none of the
+    lanes left changes
+    */
+    __attribute__((target("avx2"))) static void propagateLockstepAvx2(LockstepGroup& group)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i one = _mm256_set1_epi16(1);
+        const __m256i full = _mm256_set1_epi16(-1);
+        const __m256i all = _mm256_set1_epi16(static_cast<short>(ALL_DIGITS));
+        __m256i dead = zero;
+        __m256i changed;
+        do
+        {
+            changed = zero;
+            for (size_t u = 0; u < UNITS; ++u)
+            {
+                __m256i placed = zero;
+                __m256i repeated = zero;
+                __m256i once = zero;
+                __m256i twice = zero;
+                for (size_t k = 0; k < SIZE; ++k)
+                {
+                    __m256i domain = _mm256_load_si256(reinterpret_cast<const __m256i*>(group.cand[unitCell(u, k)]));
+                    //An empty domain counts as a single here, placing nothing
+                    __m256i single = _mm256_cmpeq_epi16(_mm256_and_si256(domain, _mm256_sub_epi16(domain, one)), zero);
+                    __m256i digit = _mm256_and_si256(domain, single);
+                    repeated = _mm256_or_si256(repeated, _mm256_and_si256(placed, digit));
+                    placed = _mm256_or_si256(placed, digit);
+                    dead = _mm256_or_si256(dead, _mm256_cmpeq_epi16(domain, zero));
+                    addUnion(once, twice, domain, zero);
+                }
+                dead = _mm256_or_si256(dead, _mm256_andnot_si256(_mm256_cmpeq_epi16(repeated, zero), full));
+                dead = _mm256_or_si256(dead, _mm256_andnot_si256(_mm256_cmpeq_epi16(once, all), full));
+                __m256i hidden = _mm256_andnot_si256(placed, _mm256_andnot_si256(twice, once));
+                for (size_t k = 0; k < SIZE; ++k)
+                {
+                    __m256i* cell = reinterpret_cast<__m256i*>(group.cand[unitCell(u, k)]);
+                    __m256i domain = _mm256_load_si256(cell);
+                    __m256i single = _mm256_cmpeq_epi16(_mm256_and_si256(domain, _mm256_sub_epi16(domain, one)), zero);
+                    //Singles keep their value, other domains lose the placed digits,
+                    //and keep only their hidden single if they have one
+                    __m256i narrowed = _mm256_blendv_epi8(_mm256_andnot_si256(placed, domain), domain, single);
+                    __m256i found = _mm256_and_si256(narrowed, hidden);
+                    narrowed = _mm256_blendv_epi8(found, narrowed, _mm256_cmpeq_epi16(found, zero));
+                    changed = _mm256_or_si256(changed, _mm256_xor_si256(domain, narrowed));
+                    _mm256_store_si256(cell, narrowed);
+                }
+            }
+            changed = _mm256_andnot_si256(dead, changed);
+        }
+        while (!_mm256_testz_si256(changed, changed));
+        __m256i open = zero;
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            __m256i domain = _mm256_load_si256(reinterpret_cast<const __m256i*>(group.cand[cell]));
+            open = _mm256_or_si256(open, _mm256_and_si256(domain, _mm256_sub_epi16(domain, one)));
+        }
+        alignas(32) uint16_t lanes[2][LANES];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[0]), dead);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[1]), open);
+        for (size_t lane = 0; lane < LANES; ++lane)
+        {
+            group.status[lane] = lanes[0][lane] != 0 ? LaneStatus::NO_SOLUTION :
+                                 lanes[1][lane] != 0 ? LaneStatus::OPEN : LaneStatus::SOLVED;
+        }
+    }
+#endif
+
+    /*
+    Applies naked and hidden singles to every puzzle of the group until neither makes progress,
+    and sets the status of each lane
+    A puzzle they solve has exactly 1 solution, since every value they place is forced
+    */
+    static void propagateLockstep(LockstepGroup& group)
+    {
+#ifdef HAVE_AVX2_KERNELS
+        if constexpr (VECTOR)
+        {
+            if (useAvx2)
+            {
+                propagateLockstepAvx2(group);
+                return;
+            }
+        }
+#endif
+        for (size_t lane = 0; lane < LANES; ++lane)
+        {
+            bool open = false;
+            bool consistent = propagateLane(group, lane);
+            for (size_t cell = 0; cell < CELLS && consistent && !open; ++cell)
+            {
+                Mask domain = group.cand[cell][lane];
+                open = (domain & (domain - 1)) != 0;
+            }
+            group.status[lane] = !consistent ? LaneStatus::NO_SOLUTION : open ? LaneStatus::OPEN : LaneStatus::SOLVED;
+        }
+    }
+
+    /*
+    One change to the board, recorded so that it can be undone on backtrack
+    oldDomain is the domain of cell before the change
+    digit is the digit placed in cell by the change, 0 if it only narrowed the domain
+    source is the cell whose value was propagated to make the change, or CELLS if it was not made
+    by propagation, and prev is 1 + the position of the last change to cell before this one, 0 if there
+    is none, see explain
+    */
+    struct TrailEntry
+    {
+        Index cell;
+        uint8_t digit;
+        uint16_t source;
+        uint16_t prev;
+        Mask oldDomain;
+    };
+
+    /*
+    Sudoku as an exact cover matrix for Dancing Links
+    Each column is a constraint that must be met exactly once: a cell holds a digit,
+    and a row, column or grid holds each digit
+    Each matrix row is one digit in one cell and has a node in the 4 columns it meets
+    The nodes are kept in arrays and linked by index, headers first and the root after them
+    */
+    static constexpr size_t DLX_COLUMNS = 4 * CELLS;
+    static constexpr size_t DLX_ROWS = CELLS * SIZE;
+    static constexpr size_t DLX_ROOT = DLX_COLUMNS;
+    static constexpr size_t DLX_NODES = DLX_COLUMNS + 1 + 4 * DLX_ROWS;
+    static_assert(DLX_NODES <= 65536, "DLX nodes are linked by 16 bit indices");
+
+    struct DlxMatrix
+    {
+        bool built = false;
+        std::vector<uint16_t> left, right, up, down;
+        //Column header of each node and matrix row of each node
+        std::vector<uint16_t> column, row;
+        //Number of nodes left in each column
+        std::vector<uint16_t> size;
+        //First node of each matrix row
+        std::vector<uint16_t> rowNode;
+        //Matrix rows chosen so far, the given digits first
+        std::vector<uint16_t> chosen;
+    };
+
+    /*
+    Most entries the trail can hold: along 1 branch of the search, every cell is changed
+    at most once per legal value and assigned once
+    */
+    static constexpr size_t TRAIL_CAPACITY = CELLS * (SIZE + 1);
+    static_assert(TRAIL_CAPACITY < 65536, "changes to a cell are linked by 16 bit positions");
+
+    /*
+    Sets of levels of the search, which are numbered from 0 like the frames of the stack
+    There are at most CELLS levels, so they are held in a CellSet
+    */
+    using LevelSet = CellSet;
+
+    /*
+    One level of the search, see backtrack
+    rest holds the values of cell not tried yet, and mark the size of the trail before trying them
+    With ValueOrder::LCV, order holds the values in the order they are tried, see orderValues
+    With backjumping, conflicts holds the earlier levels that the values tried so far failed because of,
+    and found is set once a solution was found below the level, see jumpBack
+    */
+    struct SearchFrame
+    {
+        Index cell;
+        Mask rest;
+        size_t mark;
+        uint8_t order[SIZE];
+        LevelSet conflicts;
+        bool found;
+    };
+
+    /*
+    Nogoods are sets of decisions of the search shown to have no solution, kept by recordNogood
+    Each decision is a literal, cell * SIZE + digit - 1
+    Longer nogoods are not kept, since they are less likely to come up again
+    */
+    static constexpr size_t MAX_NOGOOD_LITERALS = 16;
+
+    /*
+    Bounded store of nogoods: once full, each new nogood replaces the oldest one
+    The literals of the nogood in slot s start at s * MAX_NOGOOD_LITERALS, and the first of them is watched:
+    watches holds the first slot watching each literal and next the slot after it, -1 at the end,
+    so the slots to check when a literal is tried are found without looking at the others
+    */
+    struct NogoodStore
+    {
+        std::vector<uint16_t> literals;
+        std::vector<uint8_t> lengths;
+        std::vector<int32_t> watches;
+        std::vector<int32_t> next;
+        size_t count = 0;
+        size_t oldest = 0;
+    };
+
+    /*
+    State of the search
+    Every change made to the board during the search is recorded on the trail
+    The trail is reserved to its capacity once, and the stack holds a frame per assigned cell,
+    so the search itself never allocates memory
+    buckets[k] holds the unassigned cells with k legal values left, for the MRV heuristic
+    They are kept up to date as domains shrink and grow, see moveToBucket
+    */
+    struct SearchContext
+    {
+        Board board;
+        std::vector<TrailEntry> trail;
+        //1 + the position of the last change to each cell on the trail, 0 if there is none
+        uint16_t lastChange[CELLS];
+        SearchFrame stack[CELLS];
+        CellSet buckets[SIZE + 1];
+        SolveOptions options;
+        LogicStats logic;
+        uint64_t rngState = 0;
+        //Number of solutions found so far and the first of them
+        size_t solutions = 0;
+        Board solution;
+        SearchStats stats;
+        //Set when the search ran out of budget before finishing, see overBudget
+        bool aborted = false;
+        //Work counted against the budgets, even when the search stats are compiled out
+        size_t budgetNodes = 0;
+        size_t budgetBacktracks = 0;
+        std::chrono::steady_clock::time_point deadline;
+        //Set by another thread to stop the search early, see overBudget
+        const std::atomic<bool>* cancel = nullptr;
+        //While not null, backtrack leaves the nodes at depth splitDepth to be searched later and adds them here
+        std::vector<Board>* subproblems = nullptr;
+        size_t splitDepth = 0;
+        //Last cell whose domain was wiped out, see removeFromDomain
+        size_t wipedOut = 0;
+        //Level of the search each cell was last branched on at, and the nogoods found by backjumping
+        Index levelOf[CELLS] = {};
+        NogoodStore nogoods;
+        //Only built when the DLX engine is used
+        DlxMatrix dlx;
+    };
+
+    /*
+    Returns the next number of the search's random number generator (splitmix64)
+    Each search has its own state, so a run can be reproduced from its seed
+    */
+    static inline uint64_t nextRandom(SearchContext& ctx)
+    {
+        uint64_t z = (ctx.rngState += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /*
+    Returns a random number from 0 to n - 1
+    */
+    static inline size_t randomBelow(SearchContext& ctx, size_t n)
+    {
+        return static_cast<size_t>((static_cast<unsigned __int128>(nextRandom(ctx)) * n) >> 64);
+    }
+
+    /*
+    Moves an unassigned cell from the MRV bucket of its old domain size to the bucket of its new one
+    */
+    static inline void moveToBucket(SearchContext& ctx, size_t cell, Mask oldDomain, Mask newDomain)
+    {
+        removeCell(ctx.buckets[countDigits(oldDomain)], cell);
+        addCell(ctx.buckets[countDigits(newDomain)], cell);
+    }
+
+    /*
+    Fills the MRV buckets from scratch with the unassigned cells of the board
+    */
+    static void buildBuckets(SearchContext& ctx)
+    {
+        for (auto& bucket : ctx.buckets)
+        {
+            bucket = CellSet{};
+        }
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            if (ctx.board.cells[cell] == 0)
+            {
+                addCell(ctx.buckets[countDigits(ctx.board.cand[cell])], cell);
+            }
+        }
+    }
+
+    /*
+    Implements Minimum Remaining Value Heuristic for Sudoku
+    Inputs:
+    The current search, whose buckets map remaining values to unassigned cells
+    The minimum amount of remaining values found in the domain of an unassigned cell
+    The cell with that minimum, if it is the only one
+    Output:
+    True if single cell mapped to mrv
+    False otherwise
+    If false, proceed to degree heuristic on the cells in ctx.buckets[min]
+
+    Note: Since the buckets are kept up to date during the search,
+    this only has to find the first non-empty bucket instead of looping through the domain
+    */
+    static bool mrv(const SearchContext& ctx, size_t& min, size_t& cell)
+    {
+        //At least 1 cell is unassigned, since a complete assignment
+        //has already been checked for before calling mrv
+        //Propagation can leave an unassigned cell with only 1 legal value
+        for (min = 1; min < SIZE; ++min)
+        {
+            if (firstCell(ctx.buckets[min]) != CELLS)
+            {
+                break;
+            }
+        }
+        const CellSet& remainingVars = ctx.buckets[min];
+        cell = firstCell(remainingVars);
+        //If more than 1 possible var, return false and use degree heuristic
+        return nextCell(remainingVars, cell) == CELLS;
+    }
+
+    /*
+    Returns how many unassigned neighbors (peers) the specified cell has
+    unassigned is the set of unassigned cells of the board
+    */
+    static inline size_t countUnassignedPeers(const CellSet& unassigned, size_t cell)
+    {
+        size_t count = 0;
+        for (size_t w = 0; w < CELL_WORDS; ++w)
+        {
+            count += static_cast<size_t>(__builtin_popcountll(TABLES.peerSets[cell].words[w] & unassigned.words[w]));
+        }
+        return count;
+    }
+
+    /*
+    Implements degree heuristic for Sudoku
+    Returns the cell to branch on among the remaining variables,
+    the one with the most unassigned neighbors
+    */
+    static size_t deg(SearchContext& ctx, const CellSet& remainingVars)
+    {
+        //Every unassigned cell is in one of the MRV buckets
+        CellSet unassigned{};
+        for (const auto& bucket : ctx.buckets)
+        {
+            for (size_t w = 0; w < CELL_WORDS; ++w)
+            {
+                unassigned.words[w] |= bucket.words[w];
+            }
+        }
+        //Keep track of the remaining variables with the most unassigned neighbors
+        size_t tied[CELLS];
+        size_t numTied = 0;
+        size_t maxUnassignedNeighbors = 0;
+        //Loop through the remaining variables
+        for (size_t x = firstCell(remainingVars); x < CELLS; x = nextCell(remainingVars, x))
+        {
+            size_t numUnNeighbors = countUnassignedPeers(unassigned, x);
+            if (numUnNeighbors > maxUnassignedNeighbors)
+            {//Update max if there is a variable with more unassigned neighbors
+                maxUnassignedNeighbors = numUnNeighbors;
+                numTied = 0;
+            }
+            if (numUnNeighbors == maxUnassignedNeighbors)
+            {
+                tied[numTied++] = x;
+            }
+        }
+        COUNT_STAT(ctx.stats.tieBreaks += numTied > 1);
+        if (numTied == 1 || ctx.options.tieBreak == TieBreak::FIRST)
+        {//If only 1 possible var, or ties go to the first one, return it
+            return tied[0];
+        }
+        //Else, randomly choose among the vars with same maxUnassignedNeighbors
+        return tied[randomBelow(ctx, numTied)];
+    }
+
+    /*
+    Returns a selected unassigned variable to branch off by setting values later on
+    */
+    static size_t selectUnassignedVar(SearchContext& ctx)
+    {
+        //Run Minimum Remaining Value Heuristic
+        size_t min = SIZE + 1;//More than any domain can hold
+        size_t cell = CELLS;
+        if (mrv(ctx, min, cell) || min == 1)
+        {//A cell with 1 value left is forced, so there is no choice for the degree heuristic to make
+            COUNT_STAT(++ctx.stats.mrvDecisions);
+            return cell;
+        }
+        //If mrv fails, then run degree heuristic
+        COUNT_STAT(++ctx.stats.degreeDecisions);
+        return deg(ctx, ctx.buckets[min]);
+    }
+
+    /*
+    Helper function for checking consistency
+    Adds digit to seen, the mask of digits already seen in a row, column or grid
+    If the digit was already seen, then it is used more than once and it returns false
+    Otherwise, it is locally consistent and returns true
+    0 can be used more than once, since it indicates there is no value assigned there
+    */
+    static bool tallyUsed(Mask& seen, uint8_t digit)
+    {
+        if (digit == 0)
+        {
+            return true;
+        }
+        Mask bit = digitBit(digit);
+        if (seen & bit)
+        {//If this digit is used more than once, we need to return false
+            return false;
+        }
+        seen |= bit;
+        return true;
+    }
+
+    /*
+    Checks to see if all rows of an assignment of the board is consistent
+    Returns true if it is consistent
+    False if not consistent
+    */
+    static bool checkConsistentRows(const Board& board)
+    {
+        for (size_t i = 0; i < SIZE; ++i)
+        {
+            //Mask of the digits used so far in the row
+            Mask seen = 0;
+            for (size_t j = 0; j < SIZE; ++j)
+            {
+                if (!tallyUsed(seen, board.cells[i * SIZE + j]))
+                {//If this row is inconsistent, return false immediately
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+    Checks to see if all columns of an assignment of the board is consistent
+    Returns true if it is consistent
+    False if not consistent
+    */
+    static bool checkConsistentCols(const Board& board)
+    {
+        for (size_t j = 0; j < SIZE; ++j)
+        {
+            //Mask of the digits used so far in the col
+            Mask seen = 0;
+            for (size_t i = 0; i < SIZE; ++i)
+            {
+                if (!tallyUsed(seen, board.cells[i * SIZE + j]))
+                {//If this col is inconsistent, return false immediately
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+    Helper function for checkConsistentGrids
+    Does the actual checking in a grid
+    r0, r1 are used for row bounds
+    c0, c1 are used for col bounds
+    Returns true if local grid constraint met
+    False if inconsistent
+    */
+    static bool checkConsistentGridsHelp(const Board& board,
+        const size_t r0, const size_t r1, const size_t c0, const size_t c1)
+    {
+        //Mask of the digits used so far in the grid
+        Mask seen = 0;
+        //x,y used to navigate
+        for (size_t x = r0; x <= r1; ++x)
+        {
+            for (size_t y = c0; y <= c1; ++y)
+            {
+                if (!tallyUsed(seen, board.cells[x * SIZE + y]))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+    Checks to see if all grids of an assignment of the board is consistent
+    Returns true if it is consistent
+    False if not consistent
+    */
+    static bool checkConsistentGrids(const Board& board)
+    {
+        for (size_t r0 = 0; r0 < SIZE; r0 += BOX)
+        {
+            for (size_t c0 = 0; c0 < SIZE; c0 += BOX)
+            {
+                if (!checkConsistentGridsHelp(board, r0, r0 + BOX - 1, c0, c0 + BOX - 1))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+    Checks to see if an assignment of the board is consistent
+    Returns true if it is consistent
+    False if not consistent
+    */
+    static bool isConsistent(const Board& board)
+    {
+#ifdef HAVE_AVX2_KERNELS
+        if constexpr (VECTOR)
+        {
+            if (useAvx2)
+            {//A digit used twice in a unit shows up in the unions of the digits placed
+                alignas(32) Mask placed[PADDED_CELLS];
+                placedMasks(board, placed);
+                Mask once[UNITS];
+                Mask twice[UNITS];
+                unitUnions(placed, once, twice);
+                Mask repeated = 0;
+                for (size_t u = 0; u < UNITS; ++u)
+                {
+                    repeated |= twice[u];
+                }
+                return repeated == 0;
+            }
+        }
+#endif
+        return checkConsistentRows(board) && checkConsistentCols(board) && checkConsistentGrids(board);
+    }
+
+    /*
+    Checks to see if digit can be placed in cell without breaking consistency
+    Only the row, column and grid of the cell can be affected by the placement,
+    so only their used masks are checked instead of rescanning the whole board
+    Returns true if it is consistent
+    False if not consistent
+    */
+    static bool isConsistentPlacement(const Board& board, size_t cell, uint8_t digit)
+    {
+        Mask used = board.rowUsed[rowOf(cell)] | board.colUsed[colOf(cell)] | board.gridUsed[gridOf(cell)];
+        return (used & digitBit(digit)) == 0;
+    }
+
+    /*
+    Removes the digits in mask from the domain of cell, recording the old domain on the trail
+    source is the cell whose value is being propagated, or CELLS for a removal made by a logic rule
+    Returns false, and sets ctx.wipedOut, if the domain is wiped out
+    */
+    static bool removeFromDomain(SearchContext& ctx, size_t cell, Mask mask, size_t source = CELLS)
+    {
+        Mask domain = ctx.board.cand[cell];
+        if ((domain & mask) == 0)
+        {//Nothing to remove
+            return true;
+        }
+        ctx.trail.push_back({static_cast<Index>(cell), 0, static_cast<uint16_t>(source), ctx.lastChange[cell], domain});
+        ctx.lastChange[cell] = static_cast<uint16_t>(ctx.trail.size());
+        ctx.board.cand[cell] = domain & ~mask;
+        if (ctx.board.cells[cell] == 0)
+        {
+            moveToBucket(ctx, cell, domain, ctx.board.cand[cell]);
+        }
+        if (ctx.board.cand[cell] == 0)
+        {
+            ctx.wipedOut = cell;
+            return false;
+        }
+        return true;
+    }
+
+    /*
+    Places digit in cell and narrows its domain to digit, recording both on the trail
+    */
+    static void assignCell(SearchContext& ctx, size_t cell, uint8_t digit)
+    {
+        ctx.trail.push_back({static_cast<Index>(cell), digit, static_cast<uint16_t>(CELLS), ctx.lastChange[cell], ctx.board.cand[cell]});
+        ctx.lastChange[cell] = static_cast<uint16_t>(ctx.trail.size());
+        removeCell(ctx.buckets[countDigits(ctx.board.cand[cell])], cell);
+        placeDigit(ctx.board, cell, digit);
+        ctx.board.cand[cell] = digitBit(digit);
+    }
+
+    /*
+    Undoes every change made to the board since the trail had mark entries
+    */
+    static void undoTrail(SearchContext& ctx, size_t mark)
+    {
+        while (ctx.trail.size() > mark)
+        {
+            const TrailEntry& entry = ctx.trail.back();
+            if (entry.digit != 0)
+            {//The cell is unassigned again
+                removeDigit(ctx.board, entry.cell);
+                addCell(ctx.buckets[countDigits(entry.oldDomain)], entry.cell);
+            }
+            else if (ctx.board.cells[entry.cell] == 0)
+            {
+                moveToBucket(ctx, entry.cell, ctx.board.cand[entry.cell], entry.oldDomain);
+            }
+            ctx.board.cand[entry.cell] = entry.oldDomain;
+            ctx.lastChange[entry.cell] = entry.prev;
+            ctx.trail.pop_back();
+        }
+    }
+
+    /*
+    Helper function for pruneDigitFromPeers
+    Removes the digit bit, the value of cell, from the domain of peer
+    If enqueue is set, a peer that is left with only 1 legal value is added to the queue
+    Returns false if the domain of peer is wiped out
+    */
+    static bool prunePeer(SearchContext& ctx, size_t cell, size_t peer, Mask bit, bool enqueue, size_t* queue, size_t& queueEnd)
+    {
+        if ((ctx.board.cand[peer] & bit) == 0)
+        {
+            return true;
+        }
+        if (!removeFromDomain(ctx, peer, bit, cell))
+        {
+            return false;
+        }
+        if (enqueue && ctx.board.cells[peer] == 0 && countDigits(ctx.board.cand[peer]) == 1)
+        {
+            queue[queueEnd++] = peer;
+        }
+        return true;
+    }
+
+    /*
+    Removes digit from the domains of the peers of cell, the other cells in its row, column and grid
+    Returns false if the domain of a peer is wiped out
+    */
+    static bool pruneDigitFromPeers(SearchContext& ctx, size_t cell, uint8_t digit, bool enqueue, size_t* queue, size_t& queueEnd)
+    {
+        Mask bit = digitBit(digit);
+        for (const Index peer : TABLES.peers[cell])
+        {
+            if (!prunePeer(ctx, cell, peer, bit, enqueue, queue, queueEnd))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+    Propagates the values of the cells in the queue, which all have only 1 legal value
+    With AC3, peers narrowed down to 1 legal value are added to the queue and propagated too
+    The queue must have room for every cell of the board
+    Returns false if a domain is wiped out, so the current assignment has no solution
+    */
+    static bool propagate(SearchContext& ctx, size_t* queue, size_t queueEnd)
+    {
+        if (ctx.options.propagation == Propagation::NONE)
+        {
+            return true;
+        }
+        bool ac3 = ctx.options.propagation == Propagation::AC3;
+        for (size_t head = 0; head < queueEnd; ++head)
+        {
+            size_t cell = queue[head];
+            COUNT_STAT(++ctx.stats.propagations);
+            if (!pruneDigitFromPeers(ctx, cell, lowestDigit(ctx.board.cand[cell]), ac3, queue, queueEnd))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+    Sets up the MRV buckets and propagates the digits given in the puzzle before the search starts
+    Returns false if the puzzle is found to have no solution
+    */
+    static bool propagateGivens(SearchContext& ctx)
+    {
+        buildBuckets(ctx);
+        size_t queue[CELLS];
+        size_t queueEnd = 0;
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            if (ctx.board.cells[cell] != 0)
+            {
+                queue[queueEnd++] = cell;
+            }
+        }
+        return propagate(ctx, queue, queueEnd);
+    }
+
+    /*
+    Assigns digit to cell and propagates it
+    Returns false if the assignment is found to have no solution
+    The changes are left on the trail either way
+    */
+    static bool assign(SearchContext& ctx, size_t cell, uint8_t digit)
+    {
+        assignCell(ctx, cell, digit);
+        size_t queue[CELLS];
+        size_t queueEnd = 0;
+        queue[queueEnd++] = cell;
+        return propagate(ctx, queue, queueEnd);
+    }
+
+    /*
+    Returns the mask of the digits already placed in unit u
+    */
+    static inline Mask unitUsed(const Board& board, size_t u)
+    {
+        if (u < SIZE)
+        {
+            return board.rowUsed[u];
+        }
+        if (u < 2 * SIZE)
+        {
+            return board.colUsed[u - SIZE];
+        }
+        return board.gridUsed[u - 2 * SIZE];
+    }
+
+    /*
+    Places a digit deduced by a logic rule and propagates it
+    The domains may not reflect every placed digit when propagation is off,
+    so the placement is checked first
+    Returns false if the deduction shows the board has no solution
+    */
+    static bool placeByLogic(SearchContext& ctx, size_t cell, uint8_t digit)
+    {
+        return isConsistentPlacement(ctx.board, cell, digit) && assign(ctx, cell, digit);
+    }
+
+    /*
+    Removes the digits in mask from the unassigned cells of unit u,
+    except for the cells at the positions set in keep
+    Sets changed if a domain was narrowed
+    Returns false if a domain is wiped out
+    */
+    static bool eliminateFromUnit(SearchContext& ctx, size_t u, Mask mask, Mask keep, bool& changed)
+    {
+        for (size_t k = 0; k < SIZE; ++k)
+        {
+            size_t cell = unitCell(u, k);
+            if ((keep & (1u << k)) || ctx.board.cells[cell] != 0 || (ctx.board.cand[cell] & mask) == 0)
+            {
+                continue;
+            }
+            changed = true;
+            if (!removeFromDomain(ctx, cell, mask))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+    Naked singles: an unassigned cell with only 1 legal value gets that value
+    Returns false if the board has no solution
+    */
+    static bool applyNakedSingles(SearchContext& ctx, bool& changed)
+    {
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            Mask domain = ctx.board.cand[cell];
+            if (ctx.board.cells[cell] == 0 && countDigits(domain) == 1)
+            {
+                if (!placeByLogic(ctx, cell, lowestDigit(domain)))
+                {
+                    return false;
+                }
+                ++ctx.logic.nakedSingles;
+                changed = true;
+            }
+        }
+        return true;
+    }
+
+    /*
+    Hidden singles: a digit that fits in only 1 cell of a unit goes in that cell
+    Also finds units where a digit has no cell left
+    Returns false if the board has no solution
+    */
+    static bool applyHiddenSingles(SearchContext& ctx, bool& changed)
+    {
+#ifdef HAVE_AVX2_KERNELS
+        //With the AVX2 kernels, the unions of every unit are computed at once,
+        //and again after a digit is placed
+        bool vector = VECTOR && useAvx2;
+        bool stale = true;
+        Mask unitOnce[UNITS];
+        Mask unitTwice[UNITS];
+#endif
+        for (size_t u = 0; u < UNITS; ++u)
+        {
+            Mask used = unitUsed(ctx.board, u);
+            //Digits legal in at least 1 and in at least 2 unassigned cells of the unit
+            //The domain of an assigned cell only has its digit, which is in used, so the unions
+            //of the kernel can take in every cell
+            Mask once = 0;
+            Mask twice = 0;
+#ifdef HAVE_AVX2_KERNELS
+            if constexpr (VECTOR)
+            {
+                if (vector && stale)
+                {
+                    unitUnions(ctx.board.cand, unitOnce, unitTwice);
+                    stale = false;
+                }
+            }
+            if (vector)
+            {
+                once = unitOnce[u];
+                twice = unitTwice[u];
+            }
+            else
+#endif
+            for (size_t k = 0; k < SIZE; ++k)
+            {
+                size_t cell = unitCell(u, k);
+                if (ctx.board.cells[cell] == 0)
+                {
+                    twice |= once & ctx.board.cand[cell];
+                    once |= ctx.board.cand[cell];
+                }
+            }
+            if ((once | used) != ALL_DIGITS)
+            {//A digit has nowhere to go in this unit
+                return false;
+            }
+            Mask hidden = once & ~twice & ~used;
+            for (size_t k = 0; k < SIZE && hidden != 0; ++k)
+            {
+                size_t cell = unitCell(u, k);
+                Mask found = ctx.board.cand[cell] & hidden;
+                if (ctx.board.cells[cell] != 0 || found == 0)
+                {
+                    continue;
+                }
+                if (countDigits(found) > 1)
+                {//Two digits can only go in the same cell
+                    return false;
+                }
+                if (!placeByLogic(ctx, cell, lowestDigit(found)))
+                {
+                    return false;
+                }
+                ++ctx.logic.hiddenSingles;
+                changed = true;
+                hidden &= ~found;
+#ifdef HAVE_AVX2_KERNELS
+                stale = true;
+#endif
+            }
+        }
+        return true;
+    }
+
+    /*
+    Helper function for applyNakedSubsets
+    keep has the positions of n unassigned cells of unit u and digits the union of their domains
+    If the union has exactly n values, they are removed from the rest of the unit
+    Returns false if the board has no solution
+    */
+    static bool checkNakedSubset(SearchContext& ctx, size_t u, Mask keep, Mask digits, size_t n, bool& changed)
+    {
+        if (countDigits(digits) < n)
+        {//n cells with fewer than n values between them
+            return false;
+        }
+        if (countDigits(digits) > n)
+        {
+            return true;
+        }
+        bool narrowed = false;
+        if (!eliminateFromUnit(ctx, u, digits, keep, narrowed))
+        {
+            return false;
+        }
+        if (narrowed)
+        {
+            ++(n == 2 ? ctx.logic.nakedPairs : ctx.logic.nakedTriples);
+            changed = true;
+        }
+        return true;
+    }
+
+    /*
+    Naked subsets: if n unassigned cells of a unit only have n legal values between them,
+    those values must go in those cells, so they are removed from the rest of the unit
+    n is 2 for naked pairs and 3 for naked triples
+    Returns false if the board has no solution
+    */
+    static bool applyNakedSubsets(SearchContext& ctx, size_t n, bool& changed)
+    {
+        for (size_t u = 0; u < UNITS; ++u)
+        {
+            //Positions in the unit of the cells that can be part of a subset, and their domains
+            Mask pos[SIZE];
+            Mask dom[SIZE];
+            size_t count = 0;
+            for (size_t k = 0; k < SIZE; ++k)
+            {
+                size_t cell = unitCell(u, k);
+                size_t size = countDigits(ctx.board.cand[cell]);
+                if (ctx.board.cells[cell] == 0 && size >= 2 && size <= n)
+                {
+                    pos[count] = static_cast<Mask>(1u << k);
+                    dom[count] = ctx.board.cand[cell];
+                    ++count;
+                }
+            }
+            for (size_t a = 0; a < count; ++a)
+            {
+                for (size_t b = a + 1; b < count; ++b)
+                {
+                    if (n == 2)
+                    {
+                        if (!checkNakedSubset(ctx, u, pos[a] | pos[b], dom[a] | dom[b], n, changed))
+                        {
+                            return false;
+                        }
+                        continue;
+                    }
+                    for (size_t c = b + 1; c < count; ++c)
+                    {
+                        if (!checkNakedSubset(ctx, u, pos[a] | pos[b] | pos[c], dom[a] | dom[b] | dom[c], n, changed))
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+    Helper function for applyHiddenSubsets
+    digits has n digits of unit u and positions the union of the positions where they fit
+    If the union has exactly n cells, the other values are removed from those cells
+    Returns false if the board has no solution
+    */
+    static bool checkHiddenSubset(SearchContext& ctx, size_t u, Mask digits, Mask positions, size_t n, bool& changed)
+    {
+        if (countDigits(positions) < n)
+        {//n digits with fewer than n cells between them
+            return false;
+        }
+        if (countDigits(positions) > n)
+        {
+            return true;
+        }
+        bool narrowed = false;
+        for (size_t k = 0; k < SIZE; ++k)
+        {
+            size_t cell = unitCell(u, k);
+            if ((positions & (1u << k)) && (ctx.board.cand[cell] & ~digits))
+            {
+                narrowed = true;
+                if (!removeFromDomain(ctx, cell, static_cast<Mask>(~digits)))
+                {
+                    return false;
+                }
+            }
+        }
+        if (narrowed)
+        {
+            ++(n == 2 ? ctx.logic.hiddenPairs : ctx.logic.hiddenTriples);
+            changed = true;
+        }
+        return true;
+    }
+
+    /*
+    Hidden subsets: if n digits of a unit only fit in the same n cells between them,
+    those cells must hold those digits, so their other values are removed
+    n is 2 for hidden pairs and 3 for hidden triples
+    Returns false if the board has no solution
+    */
+    static bool applyHiddenSubsets(SearchContext& ctx, size_t n, bool& changed)
+    {
+        for (size_t u = 0; u < UNITS; ++u)
+        {
+            Mask used = unitUsed(ctx.board, u);
+            //Mask of the positions in the unit where each digit still fits
+            Mask where[SIZE] = {};
+            for (size_t k = 0; k < SIZE; ++k)
+            {
+                size_t cell = unitCell(u, k);
+                if (ctx.board.cells[cell] != 0)
+                {
+                    continue;
+                }
+                for (Mask rest = ctx.board.cand[cell] & ~used; rest != 0; rest &= rest - 1)
+                {
+                    where[lowestDigit(rest) - 1] |= static_cast<Mask>(1u << k);
+                }
+            }
+            //Digits that can be part of a subset, and where they fit
+            Mask bit[SIZE];
+            Mask pos[SIZE];
+            size_t count = 0;
+            for (size_t d = 0; d < SIZE; ++d)
+            {
+                size_t size = countDigits(where[d]);
+                if (size >= 2 && size <= n)
+                {
+                    bit[count] = static_cast<Mask>(1u << d);
+                    pos[count] = where[d];
+                    ++count;
+                }
+            }
+            for (size_t a = 0; a < count; ++a)
+            {
+                for (size_t b = a + 1; b < count; ++b)
+                {
+                    if (n == 2)
+                    {
+                        if (!checkHiddenSubset(ctx, u, bit[a] | bit[b], pos[a] | pos[b], n, changed))
+                        {
+                            return false;
+                        }
+                        continue;
+                    }
+                    for (size_t c = b + 1; c < count; ++c)
+                    {
+                        if (!checkHiddenSubset(ctx, u, bit[a] | bit[b] | bit[c], pos[a] | pos[b] | pos[c], n, changed))
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+    Pointing: if a digit only fits in 1 row (or column) of a grid,
+    it is removed from the rest of that row (or column)
+    Returns false if the board has no solution
+    */
+    static bool applyPointing(SearchContext& ctx, bool& changed)
+    {
+        for (size_t g = 0; g < SIZE; ++g)
+        {
+            size_t u = 2 * SIZE + g;
+            for (Mask rest = ALL_DIGITS & ~ctx.board.gridUsed[g]; rest != 0; rest &= rest - 1)
+            {
+                Mask bit = rest & -rest;
+                //Rows and columns of the grid where the digit fits
+                Mask rows = 0;
+                Mask cols = 0;
+                for (size_t k = 0; k < SIZE; ++k)
+                {
+                    size_t cell = unitCell(u, k);
+                    if (ctx.board.cells[cell] == 0 && (ctx.board.cand[cell] & bit))
+                    {
+                        rows |= static_cast<Mask>(1u << rowOf(cell));
+                        cols |= static_cast<Mask>(1u << colOf(cell));
+                    }
+                }
+                //The cells of the grid are kept in either line
+                Mask keepRow = static_cast<Mask>(((1u << BOX) - 1) << ((g % BOX) * BOX));
+                Mask keepCol = static_cast<Mask>(((1u << BOX) - 1) << ((g / BOX) * BOX));
+                bool narrowed = false;
+                if (countDigits(rows) == 1 &&
+                    !eliminateFromUnit(ctx, __builtin_ctz(rows), bit, keepRow, narrowed))
+                {
+                    return false;
+                }
+                if (countDigits(cols) == 1 &&
+                    !eliminateFromUnit(ctx, SIZE + __builtin_ctz(cols), bit, keepCol, narrowed))
+                {
+                    return false;
+                }
+                if (narrowed)
+                {
+                    ++ctx.logic.pointing;
+                    changed = true;
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+    Box-line reduction: if a digit only fits in 1 grid of a row (or column),
+    it is removed from the rest of that grid
+    Returns false if the board has no solution
+    */
+    static bool applyBoxLine(SearchContext& ctx, bool& changed)
+    {
+        for (size_t u = 0; u < 2 * SIZE; ++u)
+        {
+            for (Mask rest = ALL_DIGITS & ~unitUsed(ctx.board, u); rest != 0; rest &= rest - 1)
+            {
+                Mask bit = rest & -rest;
+                //Grids of the line where the digit fits
+                Mask grids = 0;
+                for (size_t k = 0; k < SIZE; ++k)
+                {
+                    size_t cell = unitCell(u, k);
+                    if (ctx.board.cells[cell] == 0 && (ctx.board.cand[cell] & bit))
+                    {
+                        grids |= static_cast<Mask>(1u << gridOf(cell));
+                    }
+                }
+                if (countDigits(grids) != 1)
+                {
+                    continue;
+                }
+                //Keep the cells of the grid that are on the line
+                size_t g = __builtin_ctz(grids);
+                Mask keep = 0;
+                for (size_t k = 0; k < SIZE; ++k)
+                {
+                    size_t cell = unitCell(2 * SIZE + g, k);
+                    if ((u < SIZE && rowOf(cell) == u) || (u >= SIZE && colOf(cell) == u - SIZE))
+                    {
+                        keep |= static_cast<Mask>(1u << k);
+                    }
+                }
+                bool narrowed = false;
+                if (!eliminateFromUnit(ctx, 2 * SIZE + g, bit, keep, narrowed))
+                {
+                    return false;
+                }
+                if (narrowed)
+                {
+                    ++ctx.logic.boxLine;
+                    changed = true;
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+    Number of logic rules, see applyRule
+    */
+    static constexpr size_t LOGIC_RULES = 8;
+
+    /*
+    Applies logic rule number rule once over the whole board
+    Rules are numbered from the cheapest to the most expensive
+    Returns false if the board has no solution
+    */
+    static bool applyRule(SearchContext& ctx, size_t rule, bool& changed)
+    {
+        switch (rule)
+        {
+        case 0:
+            return applyNakedSingles(ctx, changed);
+        case 1:
+            return applyHiddenSingles(ctx, changed);
+        case 2:
+            return applyNakedSubsets(ctx, 2, changed);
+        case 3:
+            return applyHiddenSubsets(ctx, 2, changed);
+        case 4:
+            return applyPointing(ctx, changed);
+        case 5:
+            return applyBoxLine(ctx, changed);
+        case 6:
+            return applyNakedSubsets(ctx, 3, changed);
+        default:
+            return applyHiddenSubsets(ctx, 3, changed);
+        }
+    }
+
+    /*
+    Runs the logic rules on the domains until none of them makes progress
+    The rules start over from the cheapest whenever one makes progress
+    Every change is recorded on the trail, so it can also be used inside the search
+    Returns false if the board has no solution
+    */
+    static bool applyLogic(SearchContext& ctx)
+    {
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (size_t rule = 0; rule < LOGIC_RULES && !changed; ++rule)
+            {
+                if (!applyRule(ctx, rule, changed))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+    Clears what a search leaves behind: the trail, the nogoods, the solutions, the counters and the budgets used
+    The board and ctx.deadline are left as they are
+    */
+    static void resetSearch(SearchContext& ctx)
+    {
+        ctx.trail.clear();
+        ctx.trail.reserve(TRAIL_CAPACITY);
+        std::fill(std::begin(ctx.lastChange), std::end(ctx.lastChange), 0);
+        ctx.logic = LogicStats{};
+        ctx.solutions = 0;
+        ctx.stats = SearchStats{};
+        clearNogoods(ctx);
+        ctx.aborted = false;
+        ctx.budgetNodes = 0;
+        ctx.budgetBacktracks = 0;
+    }
+
+    /*
+    Starts a new solve: resets the search and starts its time budget
+    */
+    static void startSearch(SearchContext& ctx)
+    {
+        resetSearch(ctx);
+        if (ctx.options.timeLimitMs != 0)
+        {
+            ctx.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ctx.options.timeLimitMs);
+        }
+    }
+
+    /*
+    Counts a node of the search against the budgets
+    Returns true, and sets ctx.aborted, if a budget has run out and the search must stop
+    Also returns true if the search was cancelled, which is not an abort
+    */
+    static bool overBudget(SearchContext& ctx)
+    {
+        const SolveOptions& options = ctx.options;
+        ++ctx.budgetNodes;
+        if (ctx.cancel != nullptr && ctx.cancel->load(std::memory_order_relaxed))
+        {
+            return true;
+        }
+        if ((options.nodeLimit != 0 && ctx.budgetNodes > options.nodeLimit) ||
+            (options.backtrackLimit != 0 && ctx.budgetBacktracks > options.backtrackLimit) ||
+            (options.timeLimitMs != 0 && ctx.budgetNodes % TIME_CHECK_NODES == 0 &&
+             std::chrono::steady_clock::now() > ctx.deadline))
+        {
+            ctx.aborted = true;
+        }
+        return ctx.aborted;
+    }
+
+    /*
+    Fills frame.order with the values of frame.cell from least to most constraining: by how many candidates
+    of the cell's unassigned peers each one would rule out, lowest digit first among equals
+    */
+    static void orderValues(const Board& board, SearchFrame& frame)
+    {
+        size_t ruledOut[SIZE + 1] = {};
+        for (const Index peer : TABLES.peers[frame.cell])
+        {
+            if (board.cells[peer] == 0)
+            {
+                for (Mask shared = board.cand[peer] & frame.rest; shared != 0; shared &= shared - 1)
+                {
+                    ++ruledOut[lowestDigit(shared)];
+                }
+            }
+        }
+        size_t count = 0;
+        for (Mask rest = frame.rest; rest != 0; rest &= rest - 1)
+        {//Insertion sort, which keeps equal values in increasing order
+            uint8_t value = lowestDigit(rest);
+            size_t k = count++;
+            for (; k > 0 && ruledOut[frame.order[k - 1]] > ruledOut[value]; --k)
+            {
+                frame.order[k] = frame.order[k - 1];
+            }
+            frame.order[k] = value;
+        }
+    }
+
+    /*
+    Returns the next value of a frame to try, in the order chosen by ctx.options.valueOrder
+    */
+    static inline uint8_t nextValue(const SearchContext& ctx, const SearchFrame& frame)
+    {
+        if (ctx.options.valueOrder == ValueOrder::LCV)
+        {
+            for (const uint8_t value : frame.order)
+            {
+                if ((frame.rest & digitBit(value)) != 0)
+                {
+                    return value;
+                }
+            }
+        }
+        return lowestDigit(frame.rest);
+    }
+
+    /*
+    Returns the level of the search below depth that the change at position p of the trail was made at
+    */
+    static size_t levelAt(const SearchContext& ctx, size_t depth, size_t p)
+    {
+        size_t low = 0;
+        size_t high = depth - 1;
+        while (low < high)
+        {
+            size_t middle = (low + high + 1) / 2;
+            if (ctx.stack[middle].mark <= p)
+            {
+                low = middle;
+            }
+            else
+            {
+                high = middle - 1;
+            }
+        }
+        return low;
+    }
+
+    /*
+    Adds to levels every level of the search below depth whose decision led to the domains of the cells in need
+    A domain is narrowed by the decision of a level, or by the propagation of another cell, whose domain then
+    counts too, so the changes to each cell are followed back through the trail and the propagated cells added to need
+    A decision with only 1 value left is not a choice: the levels that narrowed its domain count instead
+    Changes made by the logic rules are not traced, so each brings in its level and every level before it
+    Changes made before the first level follow from the puzzle alone, so they bring in no level
+    */
+    static void explain(const SearchContext& ctx, size_t depth, CellSet need, LevelSet& levels)
+    {
+        if (depth == 0)
+        {
+            return;
+        }
+        size_t pending[CELLS];
+        size_t count = 0;
+        for (size_t cell = firstCell(need); cell < CELLS; cell = nextCell(need, cell))
+        {
+            pending[count++] = cell;
+        }
+        //Levels before this one are all brought in by the logic rules
+        size_t logicLevels = 0;
+        while (count > 0)
+        {
+            size_t cell = pending[--count];
+            for (size_t p = ctx.lastChange[cell]; p > ctx.stack[0].mark; p = ctx.trail[p - 1].prev)
+            {
+                const TrailEntry& entry = ctx.trail[p - 1];
+                size_t level = ctx.levelOf[cell];
+                if (entry.source < CELLS)
+                {
+                    if (!hasCell(need, entry.source))
+                    {
+                        addCell(need, entry.source);
+                        pending[count++] = entry.source;
+                    }
+                }
+                else if (level < depth && ctx.stack[level].cell == cell && ctx.stack[level].mark == p - 1)
+                {//The decision of a level is always its first change
+                    if (countDigits(entry.oldDomain) > 1)
+                    {
+                        addCell(levels, level);
+                    }
+                }
+                else
+                {
+                    logicLevels = std::max(logicLevels, levelAt(ctx, depth, p - 1) + 1);
+                }
+            }
+        }
+        for (size_t l = 0; l < logicLevels; ++l)
+        {
+            addCell(levels, l);
+        }
+    }
+
+    /*
+    Adds the levels before level to levels
+    */
+    static void addLevelsBefore(LevelSet& levels, size_t level)
+    {
+        for (size_t l = 0; l < level; ++l)
+        {
+            addCell(levels, l);
+        }
+    }
+
+    /*
+    Returns the literal of the nogoods for digit in cell
+    */
+    static inline uint16_t literalOf(size_t cell, uint8_t digit)
+    {
+        return static_cast<uint16_t>(cell * SIZE + digit - 1);
+    }
+
+    /*
+    Returns true if the decision of a literal is made at one of the levels of the search before depth - 1
+    */
+    static inline bool isDecided(const SearchContext& ctx, size_t depth, uint16_t literal)
+    {
+        size_t cell = literal / SIZE;
+        size_t level = ctx.levelOf[cell];
+        return level + 1 < depth && ctx.stack[level].cell == cell && ctx.board.cells[cell] == literal % SIZE + 1;
+    }
+
+    /*
+    Empties the nogood store, sized for ctx.options.nogoodLimit nogoods
+    Nogoods only hold for the puzzle they were found on, so this is done before each search
+    */
+    static void clearNogoods(SearchContext& ctx)
+    {
+        NogoodStore& store = ctx.nogoods;
+        size_t limit = ctx.options.nogoodLimit;
+        store.literals.resize(limit * MAX_NOGOOD_LITERALS);
+        store.lengths.resize(limit);
+        store.next.resize(limit);
+        store.watches.assign(limit == 0 ? 0 : CELLS * SIZE, -1);
+        store.count = 0;
+        store.oldest = 0;
+    }
+
+    /*
+    Removes the nogood in slot from the list of the literal it watches
+    */
+    static void unwatch(NogoodStore& store, size_t slot)
+    {
+        int32_t* link = &store.watches[store.literals[slot * MAX_NOGOOD_LITERALS]];
+        while (*link != static_cast<int32_t>(slot))
+        {
+            link = &store.next[*link];
+        }
+        *link = store.next[slot];
+    }
+
+    /*
+    Keeps the decisions made at levels as a nogood, watching the one made at level last, which is about to be undone
+    Once the store is full, the oldest nogood is replaced
+    */
+    static void recordNogood(SearchContext& ctx, const LevelSet& levels, size_t last)
+    {
+        NogoodStore& store = ctx.nogoods;
+        size_t length = countCells(levels);
+        if (length > MAX_NOGOOD_LITERALS)
+        {
+            return;
+        }
+        size_t slot = store.count;
+        if (store.count < ctx.options.nogoodLimit)
+        {
+            ++store.count;
+        }
+        else
+        {
+            slot = store.oldest;
+            store.oldest = (store.oldest + 1) % store.count;
+            unwatch(store, slot);
+        }
+        uint16_t* literals = &store.literals[slot * MAX_NOGOOD_LITERALS];
+        size_t n = 0;
+        literals[n++] = literalOf(ctx.stack[last].cell, ctx.board.cells[ctx.stack[last].cell]);
+        for (size_t l = firstCell(levels); l < CELLS; l = nextCell(levels, l))
+        {
+            if (l != last)
+            {
+                literals[n++] = literalOf(ctx.stack[l].cell, ctx.board.cells[ctx.stack[l].cell]);
+            }
+        }
+        store.lengths[slot] = static_cast<uint8_t>(length);
+        store.next[slot] = store.watches[literals[0]];
+        store.watches[literals[0]] = static_cast<int32_t>(slot);
+    }
+
+    /*
+    Returns true if value, tried for the cell of the frame at depth - 1, completes a nogood, so it cannot lead to a solution
+    The levels of the other decisions of the nogood are then added to the conflicts of the frame
+    A nogood is only looked at when the literal it watches is tried: if another of its literals is not decided,
+    that one is watched instead
+    */
+    static bool completesNogood(SearchContext& ctx, size_t depth, uint8_t value)
+    {
+        NogoodStore& store = ctx.nogoods;
+        SearchFrame& frame = ctx.stack[depth - 1];
+        int32_t* link = &store.watches[literalOf(frame.cell, value)];
+        while (*link >= 0)
+        {
+            size_t slot = static_cast<size_t>(*link);
+            uint16_t* literals = &store.literals[slot * MAX_NOGOOD_LITERALS];
+            size_t length = store.lengths[slot];
+            size_t k = 1;
+            while (k < length && isDecided(ctx, depth, literals[k]))
+            {
+                ++k;
+            }
+            if (k == length)
+            {
+                for (k = 1; k < length; ++k)
+                {
+                    addCell(frame.conflicts, ctx.levelOf[literals[k] / SIZE]);
+                }
+                return true;
+            }
+            std::swap(literals[0], literals[k]);
+            *link = store.next[slot];
+            store.next[slot] = store.watches[literals[0]];
+            store.watches[literals[0]] = static_cast<int32_t>(slot);
+        }
+        return false;
+    }
+
+    /*
+    Conflict-directed backjumping: called once every value of the frame at depth - 1 has failed,
+    it returns the depth to go back to instead of depth - 1
+    The values pruned from the cell before it was branched on count as failed too, so the levels that pruned them
+    are added to its conflicts. The search goes back to the last of its conflicts, since changing any level after
+    that one would leave the cell with the same values, and passes the other conflicts on to that level
+    The decisions of the conflicts are a nogood, unless a solution was found below the frame
+    Returns 0 if the frame has no conflicts, so no decision led to it and the search is over
+    */
+    static size_t jumpBack(SearchContext& ctx, size_t depth)
+    {
+        SearchFrame& frame = ctx.stack[depth - 1];
+        CellSet need{};
+        addCell(need, frame.cell);
+        explain(ctx, depth, need, frame.conflicts);
+        size_t last = lastCell(frame.conflicts);
+        if (last == CELLS)
+        {
+            return 0;
+        }
+        if (!frame.found && ctx.options.nogoodLimit != 0)
+        {
+            recordNogood(ctx, frame.conflicts, last);
+        }
+        removeCell(frame.conflicts, last);
+        SearchFrame& target = ctx.stack[last];
+        for (size_t w = 0; w < CELL_WORDS; ++w)
+        {
+            target.conflicts.words[w] |= frame.conflicts.words[w];
+        }
+        target.found |= frame.found;
+        return last + 1;
+    }
+
+    /*
+    Does the actual backtracking algorithm for the Sudoku board
+    The search is a loop over ctx.stack instead of recursion: entering a node pushes a frame
+    for the cell to branch on, and each value of the cell is tried after undoing the last one
+    Every complete assignment found is counted in ctx.solutions, and the first is kept in ctx.solution
+    Returns true once the search can stop, when ctx.options.solutionLimit solutions have been found
+    or a budget has run out, which sets ctx.aborted and leaves the board as it was at that point
+    With ctx.subproblems set, the nodes at depth ctx.splitDepth are added to it instead of being searched
+    With ctx.options.backjump, each level keeps the earlier levels its values failed because of, and a level that
+    runs out of values goes back to the last of them, see jumpBack. After a solution, it goes back 1 level at a time
+    The board must be consistent when it is called, see isConsistent
+    */
+    static bool backtrack(SearchContext& ctx)
+    {
+        Board& board = ctx.board;
+        size_t depth = 0;
+        //Set when a value was just assigned, so the search goes down to a new node
+        bool descend = true;
+        while (true)
+        {
+            if (descend)
+            {
+                COUNT_STAT(++ctx.stats.nodes);
+                if (overBudget(ctx))
+                {
+                    return true;
+                }
+                bool open = ctx.options.logicMode != LogicMode::NODE || applyLogic(ctx);
+                //Set when the node is not a dead end, but a solution or a subproblem
+                bool found = false;
+                if (open && isCompleteBoard(board))
+                {
+                    if (++ctx.solutions == 1)
+                    {
+                        ctx.solution = board;
+                    }
+                    if (ctx.solutions == ctx.options.solutionLimit)
+                    {
+                        return true;
+                    }
+                    open = false;
+                    found = true;
+                }
+                if (open && depth == ctx.splitDepth && ctx.subproblems != nullptr)
+                {//Left for searchSubproblem
+                    ctx.subproblems->push_back(board);
+                    open = false;
+                    found = true;
+                }
+                if (open)
+                {//Branch on a new cell, its values are tried in the order chosen by the options
+                    size_t cell = selectUnassignedVar(ctx);
+                    COUNT_STAT(ctx.stats.guesses += countDigits(board.cand[cell]) > 1);
+                    SearchFrame& frame = ctx.stack[depth++];
+                    frame.cell = static_cast<Index>(cell);
+                    frame.rest = board.cand[cell];
+                    frame.mark = ctx.trail.size();
+                    if (ctx.options.valueOrder == ValueOrder::LCV)
+                    {
+                        orderValues(board, frame);
+                    }
+                    if (ctx.options.backjump)
+                    {
+                        frame.conflicts = LevelSet{};
+                        frame.found = false;
+                        ctx.levelOf[cell] = static_cast<Index>(depth - 1);
+                    }
+                    COUNT_STAT(ctx.stats.maxDepth = std::max(ctx.stats.maxDepth, depth));
+                }
+                else if (ctx.options.backjump && depth > 0)
+                {//The logic rules are not traced back to levels, and every level led to a solution, so all of them count
+                    addLevelsBefore(ctx.stack[depth - 1].conflicts, depth - 1);
+                    ctx.stack[depth - 1].found |= found;
+                }
+            }
+            if (depth == 0)
+            {//Every value of the first cell has been tried
+                return false;
+            }
+            SearchFrame& frame = ctx.stack[depth - 1];
+            //Undo the last value tried, and everything it pruned
+            //Every assignment is on the trail, so a longer trail means a value was tried
+            bool tried = ctx.trail.size() > frame.mark;
+            COUNT_STAT(ctx.stats.backtracks += tried);
+            ctx.budgetBacktracks += tried;
+            undoTrail(ctx, frame.mark);
+            descend = false;
+            while (frame.rest != 0 && !descend)
+            {
+                uint8_t value = nextValue(ctx, frame);
+                frame.rest &= static_cast<Mask>(~digitBit(value));
+                if (ctx.options.nogoodLimit != 0 && ctx.options.backjump && completesNogood(ctx, depth, value))
+                {
+                    continue;
+                }
+                if (isConsistentPlacement(board, frame.cell, value))
+                {//If value is consistent with assignment, update the board and the domains with it
+                    descend = assign(ctx, frame.cell, value);
+                    if (!descend)
+                    {
+                        if (ctx.options.backjump)
+                        {//The wiped out domain is explained before its changes are undone
+                            CellSet need{};
+                            addCell(need, ctx.wipedOut);
+                            explain(ctx, depth, need, frame.conflicts);
+                        }
+                        COUNT_STAT(++ctx.stats.backtracks);
+                        ++ctx.budgetBacktracks;
+                        undoTrail(ctx, frame.mark);
+                    }
+                }
+                else if (ctx.options.backjump)
+                {//The value is placed in a peer
+                    CellSet need{};
+                    for (const Index peer : TABLES.peers[frame.cell])
+                    {
+                        if (board.cells[peer] == value)
+                        {
+                            addCell(need, peer);
+                        }
+                    }
+                    explain(ctx, depth, need, frame.conflicts);
+                }
+            }
+            if (!descend && ctx.options.backjump)
+            {//This cell is done, go back to the last level it failed because of
+                removeCell(frame.conflicts, depth - 1);
+                depth = jumpBack(ctx, depth);
+            }
+            else if (!descend)
+            {//This cell is done, go back up to the previous one
+                --depth;
+            }
+        }
+    }
+
+    /*
+    Builds the exact cover matrix, once per search context
+    Every cover made while solving is undone afterwards, so the matrix is reused as is
+    */
+    static void buildDlx(DlxMatrix& m)
+    {
+        m.left.resize(DLX_NODES);
+        m.right.resize(DLX_NODES);
+        m.up.resize(DLX_NODES);
+        m.down.resize(DLX_NODES);
+        m.column.resize(DLX_NODES);
+        m.row.resize(DLX_NODES);
+        m.size.assign(DLX_COLUMNS, 0);
+        m.rowNode.resize(DLX_ROWS);
+        m.chosen.reserve(CELLS);
+        //Headers and root in one circular list
+        for (size_t i = 0; i <= DLX_ROOT; ++i)
+        {
+            m.left[i] = uint16_t(i == 0 ? DLX_ROOT : i - 1);
+            m.right[i] = uint16_t(i == DLX_ROOT ? 0 : i + 1);
+            m.up[i] = m.down[i] = m.column[i] = uint16_t(i);
+        }
+        size_t node = DLX_ROOT + 1;
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            for (size_t d = 0; d < SIZE; ++d)
+            {
+                size_t r = cell * SIZE + d;
+                size_t cols[4] = {cell, CELLS + rowOf(cell) * SIZE + d,
+                                  2 * CELLS + colOf(cell) * SIZE + d, 3 * CELLS + gridOf(cell) * SIZE + d};
+                m.rowNode[r] = uint16_t(node);
+                for (size_t k = 0; k < 4; ++k, ++node)
+                {
+                    size_t c = cols[k];
+                    m.column[node] = uint16_t(c);
+                    m.row[node] = uint16_t(r);
+                    //Append to the bottom of the column
+                    m.up[node] = m.up[c];
+                    m.down[node] = uint16_t(c);
+                    m.down[m.up[c]] = uint16_t(node);
+                    m.up[c] = uint16_t(node);
+                    ++m.size[c];
+                    //Link to the other nodes of the row
+                    m.left[node] = uint16_t(k == 0 ? node + 3 : node - 1);
+                    m.right[node] = uint16_t(k == 3 ? node - 3 : node + 1);
+                }
+            }
+        }
+        m.built = true;
+    }
+
+    /*
+    Removes column c from the header list and every row that meets c from the other columns
+    */
+    static void coverColumn(DlxMatrix& m, size_t c)
+    {
+        m.right[m.left[c]] = m.right[c];
+        m.left[m.right[c]] = m.left[c];
+        for (size_t i = m.down[c]; i != c; i = m.down[i])
+        {
+            for (size_t j = m.right[i]; j != i; j = m.right[j])
+            {
+                m.down[m.up[j]] = m.down[j];
+                m.up[m.down[j]] = m.up[j];
+                --m.size[m.column[j]];
+            }
+        }
+    }
+
+    /*
+    Undoes coverColumn, in the reverse order
+    */
+    static void uncoverColumn(DlxMatrix& m, size_t c)
+    {
+        for (size_t i = m.up[c]; i != c; i = m.up[i])
+        {
+            for (size_t j = m.left[i]; j != i; j = m.left[j])
+            {
+                ++m.size[m.column[j]];
+                m.down[m.up[j]] = uint16_t(j);
+                m.up[m.down[j]] = uint16_t(j);
+            }
+        }
+        m.right[m.left[c]] = uint16_t(c);
+        m.left[m.right[c]] = uint16_t(c);
+    }
+
+    /*
+    Algorithm X: covers the column with the fewest nodes and tries each of its rows
+    Every cover is undone before returning, even when the search stops early
+    depth is the number of rows chosen by the search so far
+    Returns true once ctx.options.solutionLimit solutions are found, or a budget has run out
+    */
+    static bool searchDlx(SearchContext& ctx, size_t depth)
+    {
+        DlxMatrix& m = ctx.dlx;
+        COUNT_STAT(++ctx.stats.nodes);
+        COUNT_STAT(ctx.stats.maxDepth = std::max(ctx.stats.maxDepth, depth));
+        if (overBudget(ctx))
+        {
+            return true;
+        }
+        if (m.right[DLX_ROOT] == DLX_ROOT)
+        {//Every constraint is met, the chosen rows are a solution
+            if (ctx.solutions++ == 0)
+            {
+                for (uint16_t r : m.chosen)
+                {
+                    placeDigit(ctx.solution, r / SIZE, r % SIZE + 1);
+                }
+            }
+            return ctx.solutions == ctx.options.solutionLimit;
+        }
+        size_t best = m.right[DLX_ROOT];
+        for (size_t c = m.right[best]; c != DLX_ROOT && m.size[best] > 1; c = m.right[c])
+        {
+            if (m.size[c] < m.size[best])
+            {
+                best = c;
+            }
+        }
+        if (m.size[best] == 0)
+        {//A constraint can no longer be met
+            return false;
+        }
+        COUNT_STAT(ctx.stats.guesses += m.size[best] > 1);
+        bool done = false;
+        coverColumn(m, best);
+        for (size_t i = m.down[best]; i != best && !done; i = m.down[i])
+        {
+            m.chosen.push_back(m.row[i]);
+            for (size_t j = m.right[i]; j != i; j = m.right[j])
+            {
+                coverColumn(m, m.column[j]);
+            }
+            done = searchDlx(ctx, depth + 1);
+            COUNT_STAT(ctx.stats.backtracks += !done);
+            ctx.budgetBacktracks += !done;
+            for (size_t j = m.left[i]; j != i; j = m.left[j])
+            {
+                uncoverColumn(m, m.column[j]);
+            }
+            m.chosen.pop_back();
+        }
+        uncoverColumn(m, best);
+        return done;
+    }
+
+    /*
+    Solves the puzzle in ctx.board with the DLX engine
+    The given digits are chosen first, then searchDlx finds the rest
+    Returns the number of solutions found, the first is left in ctx.solution
+    */
+    static size_t solveDlx(SearchContext& ctx)
+    {
+        DlxMatrix& m = ctx.dlx;
+        if (!m.built)
+        {
+            buildDlx(m);
+        }
+        startSearch(ctx);
+        //Two givens that clash would share a column, so they are ruled out first
+        if (!isConsistent(ctx.board))
+        {
+            return 0;
+        }
+        ctx.solution = ctx.board;
+        m.chosen.clear();
+        for (size_t cell = 0; cell < CELLS; ++cell)
+        {
+            if (ctx.board.cells[cell] != 0)
+            {
+                size_t node = m.rowNode[cell * SIZE + ctx.board.cells[cell] - 1];
+                m.chosen.push_back(m.row[node]);
+                coverColumn(m, m.column[node]);
+                for (size_t j = m.right[node]; j != node; j = m.right[j])
+                {
+                    coverColumn(m, m.column[j]);
+                }
+            }
+        }
+        size_t givens = m.chosen.size();
+        searchDlx(ctx, 0);
+        //Uncover the givens in reverse, which leaves the matrix as it was built
+        for (size_t k = givens; k-- > 0;)
+        {
+            size_t node = m.rowNode[m.chosen[k]];
+            for (size_t j = m.left[node]; j != node; j = m.left[j])
+            {
+                uncoverColumn(m, m.column[j]);
+            }
+            uncoverColumn(m, m.column[node]);
+        }
+        m.chosen.clear();
+        return ctx.solutions;
+    }
+
+    /*
+    Sets up a search on the puzzle in ctx.board: builds the domains, checks the given digits,
+    propagates them and runs the logic pre-pass if it is on
+    Returns false if the puzzle is found to have no solution
+    */
+    static bool prepareSearch(SearchContext& ctx)
+    {
+        startSearch(ctx);
+        constructDom(ctx.board);
+        //The search only checks the cells it changes, so the given digits are checked once here
+        if (!isConsistent(ctx.board) || !propagateGivens(ctx))
+        {
+            return false;
+        }
+        return ctx.options.logicMode == LogicMode::OFF || applyLogic(ctx);
+    }
+
+    /*
+    Searches a node of a split search tree, left in ctx.board by backtrack with ctx.subproblems set
+    Unlike prepareSearch, it keeps the domains of the board, and ctx.deadline, so the caller can set
+    the deadline of the whole search
+    Returns the result of backtrack
+    */
+    static bool searchSubproblem(SearchContext& ctx)
+    {
+        resetSearch(ctx);
+        buildBuckets(ctx);
+        return backtrack(ctx);
+    }
+
+    /*
+    Searches the puzzle in ctx.board for up to ctx.options.solutionLimit solutions
+    The first solution found is left on the board
+    Returns the number of solutions found
+    */
+    static size_t solveBoard(SearchContext& ctx)
+    {
+        if (ctx.options.engine == Engine::DLX)
+        {
+            solveDlx(ctx);
+        }
+        else if (prepareSearch(ctx))
+        {
+            backtrack(ctx);
+        }
+        if (ctx.solutions > 0)
+        {
+            ctx.board = ctx.solution;
+        }
+        return ctx.solutions;
+    }
+
+};
+
+/*
+Solver for other programs to link: solves, counts and propagates puzzles held in memory
+It keeps the state of a search, allocated once, so a Solver reused for many puzzles allocates nothing per puzzle
+A puzzle is CELLS digits, row by row, with 0 for a blank cell
+A Solver is used by 1 thread at a time, so each thread needs its own
+The library holds a Solver for each board size, BOX from 2 to 5
+*/
+template <size_t BOX>
+class Solver
+{
+public:
+    using Mask = typename Sudoku<BOX>::Mask;
+    static constexpr size_t SIZE = Sudoku<BOX>::SIZE;
+    static constexpr size_t CELLS = Sudoku<BOX>::CELLS;
+
+    explicit Solver(const SolveOptions& options = SolveOptions{});
+
+    /*
+    Settings of the search
+    solutionLimit is not used: solve stops at the first solution, and count takes its own limit
+    */
+    void setOptions(const SolveOptions& options);
+    const SolveOptions& options() const;
+
+    /*
+    Seeds the random number generator used by TieBreak::RANDOM, so that a run can be repeated
+    */
+    void setSeed(uint64_t seed);
+
+    /*
+    Solves the puzzle in cells and writes its solution over it
+    Returns false, leaving cells as they were, if a digit is out of range, the puzzle has no solution
+    or the search was aborted (see aborted)
+    */
+    bool solve(uint8_t* cells);
+
+    /*
+    Counts the solutions of the puzzle in cells, stopping once limit are found (0 for no limit)
+    Returns 0 if a digit is out of range
+    */
+    size_t count(const uint8_t* cells, size_t limit);
+
+    /*
+    Deduces what it can about the puzzle in cells without searching: propagates the given digits and,
+    unless the logic mode is OFF, runs the logic rules
+    Every cell narrowed down to 1 digit is written into cells, and the domain of every cell into domains
+    if it is not null
+    Returns false, leaving cells and domains as they were, if the puzzle is found to have no solution
+    */
+    bool propagate(uint8_t* cells, Mask* domains = nullptr);
+
+    /*
+    Results of the last call: whether its search ran out of budget, and the work it did
+    */
+    bool aborted() const;
+    const SearchStats& stats() const;
+    const LogicStats& logic() const;
+
+private:
+    /*
+    Copies the puzzle in cells onto the board of the search
+    Only the cells are copied: every engine rebuilds the domains and used masks from them, see constructDom
+    Returns false if a digit is out of range
+    */
+    bool load(const uint8_t* cells);
+
+    std::unique_ptr<typename Sudoku<BOX>::SearchContext> ctx;
+};
+
+extern template class Solver<2>;
+extern template class Solver<3>;
+extern template class Solver<4>;
+extern template class Solver<5>;
+
+/*
+Cache of solved 9x9 puzzles, keyed by their canonical form under the symmetries of Sudoku, see canonicalize
+Relabeling the digits, swapping rows within a band, columns within a stack, bands, stacks, and transposing
+turn a puzzle into another with the same solution transformed the same way, so all of them share 1 entry
+The cache can be shared by several threads
+Once it holds its capacity, each new puzzle replaces the one least recently looked up or added
+*/
+class SolutionCache
+{
+public:
+    static constexpr size_t SIZE = Sudoku<3>::SIZE;
+    static constexpr size_t CELLS = Sudoku<3>::CELLS;
+
+    /*
+    Symmetry that takes a puzzle to its canonical form: canonical cell (i, j) holds the digit of
+    row rows[i] and column cols[j] of the puzzle, transposed first if transpose is set, relabeled by digits
+    digits[0] is 0, so blank cells stay blank
+    */
+    struct Symmetry
+    {
+        bool transpose;
+        uint8_t rows[SIZE];
+        uint8_t cols[SIZE];
+        uint8_t digits[SIZE + 1];
+    };
+
+    /*
+    Canonical form of a puzzle, and the symmetry that took the puzzle to it
+    */
+    struct CanonicalForm
+    {
+        uint8_t cells[CELLS];
+        Symmetry symmetry;
+    };
+
+    /*
+    capacity is the most puzzles kept, 0 for no limit
+    */
+    explicit SolutionCache(size_t capacity = 0);
+
+    /*
+    Finds the canonical form of the puzzle in cells: of all the puzzles its symmetries turn it into
+    that list the bands, stacks, and the rows and columns within each, from fewest to most clues,
+    with digits relabeled in the order they are first read, the smallest read row by row
+    Returns false if the puzzle has too many symmetries that tie to finish quickly, then it is not cached
+    */
+    static bool canonicalize(const uint8_t* cells, CanonicalForm& form);
+
+    /*
+    Looks up a puzzle by its canonical form, which makes it the most recently used
+    Returns false if it is not in the cache; otherwise solved says whether it has a solution,
+    which is written over cells, the puzzle the form was made from
+    */
+    bool find(const CanonicalForm& form, uint8_t* cells, bool& solved);
+
+    /*
+    Adds the solution of the puzzle the form was made from, or nullptr if it has no solution
+    */
+    void insert(const CanonicalForm& form, const uint8_t* solution);
+
+    /*
+    Reads the puzzles saved by save into the cache, and writes the cache to a file
+    Each line holds a canonical puzzle and its canonical solution, or - if it has none
+    The least recently used puzzle is saved first, so the file is loaded back in the same order
+    Return false if the file could not be read or written
+    */
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    size_t size() const;
+
+private:
+    /*
+    Canonical puzzle and canonical solution, both CELLS digits; an empty solution means there is none
+    */
+    struct Entry
+    {
+        std::string puzzle;
+        std::string solution;
+    };
+
+    /*
+    Adds an entry, or makes it the most recently used if it is already there, and drops the least recently
+    used one if the cache is over capacity
+    The caller holds the lock
+    */
+    void add(std::string puzzle, std::string solution);
+
+    size_t capacity;
+    mutable std::mutex lock;
+    //Entries from the most to the least recently used, and each of them by its puzzle, which the key points into
+    std::list<Entry> recent;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> entries;
+};
+
+}
+
+#endif
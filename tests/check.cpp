@@ -0,0 +1,510 @@
+/*
+Sudoku Solver Using AI
+Checks of the solver library, run by make check on the corpora given on the command line
+Each check solves the same puzzles 2 ways that must agree: the AVX2 kernels against the scalar code,
+a Solver used for many puzzles against a new one for each, the solution cache against a search,
+the backjumping search against Dancing Links, and lockstep propagation against the same passes 1 puzzle at a time
+*/
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <array>
+#include <random>
+#include <algorithm>
+#include <numeric>//For iota
+#include "../sudoku.h"
+
+using namespace std;
+using namespace sudoku;
+
+using Puzzle = array<uint8_t, 81>;
+
+/*
+Number of checks that failed so far
+*/
+size_t failures = 0;
+
+/*
+Reports a failed check
+*/
+void fail(const string& check, const string& what, size_t puzzle)
+{
+    cerr << "FAIL " << check << ": " << what << " on puzzle " << puzzle << '\n';
+    ++failures;
+}
+
+/*
+Reads the puzzles of a corpus in the 1 line format, with 0 or . for a blank cell
+Exits with an error message if the file cannot be read
+*/
+vector<Puzzle> readCorpus(const string& path)
+{
+    ifstream ifs(path);
+    if (!ifs)
+    {
+        cerr << "Could not open corpus " << path << '\n';
+        exit(1);
+    }
+    vector<Puzzle> puzzles;
+    string line;
+    while (getline(ifs, line))
+    {
+        if (line.size() < 81)
+        {
+            continue;
+        }
+        Puzzle puzzle;
+        for (size_t cell = 0; cell < 81; ++cell)
+        {
+            puzzle[cell] = line[cell] == '.' ? 0 : static_cast<uint8_t>(line[cell] - '0');
+        }
+        puzzles.push_back(puzzle);
+    }
+    return puzzles;
+}
+
+/*
+Returns true if solution is a complete board that keeps the given digits of puzzle
+*/
+template <size_t BOX>
+bool isSolution(const uint8_t* puzzle, const uint8_t* solution)
+{
+    using S = Sudoku<BOX>;
+    const size_t SIZE = S::SIZE;
+    vector<uint32_t> rows(SIZE), cols(SIZE), grids(SIZE);
+    for (size_t cell = 0; cell < S::CELLS; ++cell)
+    {
+        uint8_t digit = solution[cell];
+        if (digit == 0 || digit > SIZE || (puzzle[cell] != 0 && puzzle[cell] != digit))
+        {
+            return false;
+        }
+        rows[S::rowOf(cell)] |= 1u << digit;
+        cols[S::colOf(cell)] |= 1u << digit;
+        grids[S::gridOf(cell)] |= 1u << digit;
+    }
+    uint32_t all = ((1u << SIZE) - 1) << 1;
+    return all_of(rows.begin(), rows.end(), [&](uint32_t used) { return used == all; }) &&
+           all_of(cols.begin(), cols.end(), [&](uint32_t used) { return used == all; }) &&
+           all_of(grids.begin(), grids.end(), [&](uint32_t used) { return used == all; });
+}
+
+/*
+Makes puzzles of BOX x BOX grids: solutions of the empty board, found with random tie breaks,
+with a share of their cells blanked at random
+*/
+template <size_t BOX>
+vector<vector<uint8_t>> makePuzzles(size_t count, double blank, mt19937_64& rng)
+{
+    const size_t CELLS = Sudoku<BOX>::CELLS;
+    Solver<BOX> solver;
+    bernoulli_distribution blanked(blank);
+    vector<vector<uint8_t>> puzzles;
+    for (size_t i = 0; i < count; ++i)
+    {
+        vector<uint8_t> cells(CELLS, 0);
+        solver.setSeed(rng());
+        solver.solve(cells.data());
+        for (uint8_t& cell : cells)
+        {
+            cell = blanked(rng) ? 0 : cell;
+        }
+        puzzles.push_back(cells);
+    }
+    return puzzles;
+}
+
+/*
+Settings the SIMD, reuse and backjumping checks are run with: the propagation and logic modes,
+and LCV value ordering
+Without propagation, or without logic rules, the hard 9x9 puzzles take minutes, so those modes are only
+run on small boards
+*/
+vector<SolveOptions> searchConfigs(bool smallBoard)
+{
+    vector<SolveOptions> configs;
+    for (Propagation propagation : {Propagation::NONE, Propagation::FORWARD, Propagation::AC3})
+    {
+        for (LogicMode logic : {LogicMode::OFF, LogicMode::PRE, LogicMode::NODE})
+        {
+            if (!smallBoard && (propagation == Propagation::NONE || logic == LogicMode::OFF))
+            {
+                continue;
+            }
+            SolveOptions options;
+            options.propagation = propagation;
+            options.logicMode = logic;
+            configs.push_back(options);
+        }
+    }
+    SolveOptions lcv;
+    lcv.valueOrder = ValueOrder::LCV;
+    configs.push_back(lcv);
+    return configs;
+}
+
+/*
+Solves and propagates every puzzle with the AVX2 kernels and with the scalar code, in every configuration,
+and checks that both give the same solutions, domains and search statistics
+*/
+template <size_t BOX>
+void checkSimd(const vector<vector<uint8_t>>& puzzles)
+{
+    using Mask = typename Solver<BOX>::Mask;
+    const size_t CELLS = Sudoku<BOX>::CELLS;
+    const string check = "simd " + to_string(BOX * BOX) + "x" + to_string(BOX * BOX);
+    Solver<BOX> solver;
+    for (const SolveOptions& options : searchConfigs(BOX == 2))
+    {
+        solver.setOptions(options);
+        for (size_t i = 0; i < puzzles.size(); ++i)
+        {
+            vector<uint8_t> cells[2];
+            vector<Mask> domains[2];
+            bool solved[2];
+            bool open[2];
+            SearchStats stats[2];
+            for (size_t simd = 0; simd < 2; ++simd)
+            {
+                useAvx2 = simd != 0;
+                cells[simd] = puzzles[i];
+                solver.setSeed(i);
+                solved[simd] = solver.solve(cells[simd].data());
+                stats[simd] = solver.stats();
+                vector<uint8_t> propagated = puzzles[i];
+                domains[simd].assign(CELLS, 0);
+                open[simd] = solver.propagate(propagated.data(), domains[simd].data());
+            }
+            if (solved[0] != solved[1] || cells[0] != cells[1])
+            {
+                fail(check, "different solutions", i);
+            }
+            else if (stats[0].nodes != stats[1].nodes || stats[0].guesses != stats[1].guesses ||
+                     stats[0].backtracks != stats[1].backtracks)
+            {
+                fail(check, "different search statistics", i);
+            }
+            else if (open[0] != open[1] || domains[0] != domains[1])
+            {
+                fail(check, "different domains after propagation", i);
+            }
+        }
+    }
+    useAvx2 = cpuHasAvx2();
+}
+
+/*
+Solves and counts every puzzle with 1 Solver, used for all of them in turn, and with a new Solver for each,
+and checks that both give the same results, and that every solution solves its puzzle
+*/
+template <size_t BOX>
+void checkReuse(const vector<vector<uint8_t>>& puzzles, size_t limit)
+{
+    const string check = "reuse " + to_string(BOX * BOX) + "x" + to_string(BOX * BOX);
+    for (const SolveOptions& options : searchConfigs(BOX == 2))
+    {
+        Solver<BOX> reused(options);
+        for (size_t i = 0; i < puzzles.size(); ++i)
+        {
+            Solver<BOX> fresh(options);
+            vector<uint8_t> cells[2] = {puzzles[i], puzzles[i]};
+            reused.setSeed(i);
+            fresh.setSeed(i);
+            bool solved = reused.solve(cells[0].data());
+            if (solved != fresh.solve(cells[1].data()) || cells[0] != cells[1])
+            {
+                fail(check, "different solutions", i);
+            }
+            else if (solved && !isSolution<BOX>(puzzles[i].data(), cells[0].data()))
+            {
+                fail(check, "the solution does not solve the puzzle", i);
+            }
+            else if (reused.count(puzzles[i].data(), limit) != fresh.count(puzzles[i].data(), limit))
+            {
+                fail(check, "different counts", i);
+            }
+        }
+    }
+}
+
+/*
+Applies a random symmetry of Sudoku to a 9x9 puzzle: relabels the digits, swaps rows within bands,
+columns within stacks, bands and stacks, and transposes the board half of the time
+*/
+Puzzle transform(const Puzzle& puzzle, mt19937_64& rng)
+{
+    array<uint8_t, 10> digits;
+    iota(digits.begin(), digits.end(), 0);
+    shuffle(digits.begin() + 1, digits.end(), rng);
+    array<size_t, 9> rows, cols;
+    for (array<size_t, 9>* lines : {&rows, &cols})
+    {
+        array<size_t, 3> bands = {0, 1, 2};
+        shuffle(bands.begin(), bands.end(), rng);
+        for (size_t b = 0; b < 3; ++b)
+        {
+            array<size_t, 3> within = {0, 1, 2};
+            shuffle(within.begin(), within.end(), rng);
+            for (size_t k = 0; k < 3; ++k)
+            {
+                (*lines)[b * 3 + k] = bands[b] * 3 + within[k];
+            }
+        }
+    }
+    bool transpose = rng() % 2 != 0;
+    Puzzle result;
+    for (size_t r = 0; r < 9; ++r)
+    {
+        for (size_t c = 0; c < 9; ++c)
+        {
+            size_t cell = transpose ? cols[c] * 9 + rows[r] : rows[r] * 9 + cols[c];
+            result[r * 9 + c] = digits[puzzle[cell]];
+        }
+    }
+    return result;
+}
+
+/*
+Caches the solution of every puzzle, then looks up random symmetries of it, and checks that they share
+its canonical form and that the solution found in the cache solves them, and is the one the search finds
+for puzzles with a single solution
+*/
+void checkCache(const vector<Puzzle>& puzzles, mt19937_64& rng)
+{
+    const string check = "cache";
+    const size_t variants = 8;
+    Solver<3> solver;
+    for (size_t i = 0; i < puzzles.size(); ++i)
+    {
+        SolutionCache cache;
+        SolutionCache::CanonicalForm form;
+        if (!SolutionCache::canonicalize(puzzles[i].data(), form))
+        {//Too symmetric to be cached
+            continue;
+        }
+        Puzzle solution = puzzles[i];
+        bool solved = solver.solve(solution.data());
+        cache.insert(form, solved ? solution.data() : nullptr);
+        for (size_t v = 0; v < variants; ++v)
+        {
+            Puzzle variant = transform(puzzles[i], rng);
+            SolutionCache::CanonicalForm variantForm;
+            bool found = false;
+            Puzzle cached = variant;
+            if (!SolutionCache::canonicalize(variant.data(), variantForm) ||
+                !equal(form.cells, form.cells + 81, variantForm.cells))
+            {
+                fail(check, "different canonical forms", i);
+            }
+            else if (!cache.find(variantForm, cached.data(), found) || found != solved)
+            {
+                fail(check, "missed lookup", i);
+            }
+            else if (solved && !isSolution<3>(variant.data(), cached.data()))
+            {
+                fail(check, "cached solution does not solve the variant", i);
+            }
+            else if (solved && solver.count(variant.data(), 2) == 1)
+            {
+                Puzzle searched = variant;
+                solver.solve(searched.data());
+                if (searched != cached)
+                {
+                    fail(check, "cached solution differs from the search", i);
+                }
+            }
+        }
+    }
+}
+
+/*
+Counts the solutions of every puzzle, up to limit, with backjumping in every configuration, with and without
+nogoods, and checks that the counts match Dancing Links, which shares none of the search code
+*/
+template <size_t BOX>
+void checkBackjump(const vector<vector<uint8_t>>& puzzles, size_t limit)
+{
+    const string check = "backjump " + to_string(BOX * BOX) + "x" + to_string(BOX * BOX);
+    Solver<BOX> dlx;
+    SolveOptions dlxOptions;
+    dlxOptions.engine = Engine::DLX;
+    dlx.setOptions(dlxOptions);
+    Solver<BOX> solver;
+    for (size_t i = 0; i < puzzles.size(); ++i)
+    {
+        size_t expected = dlx.count(puzzles[i].data(), limit);
+        for (SolveOptions options : searchConfigs(BOX == 2))
+        {
+            options.backjump = true;
+            for (size_t nogoods : {0, 64})
+            {
+                options.nogoodLimit = nogoods;
+                solver.setOptions(options);
+                solver.setSeed(i);
+                if (solver.count(puzzles[i].data(), limit) != expected)
+                {
+                    fail(check, "count differs from DLX", i);
+                }
+            }
+        }
+    }
+}
+
+/*
+Returns the puzzles followed by puzzles with a wrong clue, made from every third one: a blank cell given
+a digit already in its row, or a given digit replaced by another one
+Some of them are found to have no solution by singles alone, and some only by a search
+*/
+template <size_t BOX>
+vector<vector<uint8_t>> withWrongClues(const vector<vector<uint8_t>>& puzzles, mt19937_64& rng)
+{
+    using S = Sudoku<BOX>;
+    vector<vector<uint8_t>> wrong = puzzles;
+    for (size_t i = 0; i < puzzles.size(); i += 3)
+    {
+        vector<uint8_t> cells = puzzles[i];
+        size_t cell = rng() % S::CELLS;
+        if (cells[cell] != 0)
+        {
+            cells[cell] = static_cast<uint8_t>(cells[cell] % S::SIZE + 1);
+        }
+        else
+        {
+            size_t row = S::rowOf(cell) * S::SIZE;
+            for (size_t c = row; c < row + S::SIZE && cells[cell] == 0; ++c)
+            {
+                cells[cell] = cells[c];
+            }
+        }
+        wrong.push_back(cells);
+    }
+    return wrong;
+}
+
+#ifdef HAVE_AVX2_KERNELS
+/*
+Propagates the puzzles 16 at a time in lockstep with the AVX2 kernel, and 1 lane at a time with the scalar code,
+and checks that both give every lane the same status, and the same domains unless it has no solution,
+where each stops at the first contradiction it finds, and that the lanes found solved are solutions
+*/
+template <size_t BOX>
+void checkLockstep(const vector<vector<uint8_t>>& puzzles)
+{
+    using S = Sudoku<BOX>;
+    const string check = "lockstep " + to_string(BOX * BOX) + "x" + to_string(BOX * BOX);
+    vector<typename S::LockstepGroup> groups(2);
+    for (size_t begin = 0; begin < puzzles.size(); begin += S::LANES)
+    {
+        size_t lanes = min(S::LANES, puzzles.size() - begin);
+        for (typename S::LockstepGroup& group : groups)
+        {
+            for (size_t lane = 0; lane < S::LANES; ++lane)
+            {
+                S::setLane(group, lane, lane < lanes ? puzzles[begin + lane].data() : nullptr);
+            }
+        }
+        S::propagateLockstepAvx2(groups[1]);
+        for (size_t lane = 0; lane < S::LANES; ++lane)
+        {
+            bool open = false;
+            bool consistent = S::propagateLane(groups[0], lane);
+            for (size_t cell = 0; cell < S::CELLS && consistent && !open; ++cell)
+            {
+                typename S::Mask domain = groups[0].cand[cell][lane];
+                open = (domain & (domain - 1)) != 0;
+            }
+            groups[0].status[lane] = !consistent ? S::LaneStatus::NO_SOLUTION :
+                                     open ? S::LaneStatus::OPEN : S::LaneStatus::SOLVED;
+        }
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            size_t i = begin + lane;
+            bool sameDomains = true;
+            for (size_t cell = 0; cell < S::CELLS; ++cell)
+            {
+                sameDomains = sameDomains && groups[0].cand[cell][lane] == groups[1].cand[cell][lane];
+            }
+            vector<uint8_t> cells = puzzles[i];
+            S::getLane(groups[1], lane, cells.data());
+            if (groups[0].status[lane] != groups[1].status[lane])
+            {
+                fail(check, "different status", i);
+            }
+            else if (groups[1].status[lane] != S::LaneStatus::NO_SOLUTION && !sameDomains)
+            {
+                fail(check, "different domains", i);
+            }
+            else if (groups[1].status[lane] == S::LaneStatus::SOLVED && !isSolution<BOX>(puzzles[i].data(), cells.data()))
+            {
+                fail(check, "the lane found solved is not a solution", i);
+            }
+        }
+    }
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "Usage: " << argv[0] << " corpus [corpus ...]\n";
+        return 5;
+    }
+    vector<Puzzle> corpus;
+    for (int a = 1; a < argc; ++a)
+    {
+        vector<Puzzle> puzzles = readCorpus(argv[a]);
+        corpus.insert(corpus.end(), puzzles.begin(), puzzles.end());
+    }
+    vector<vector<uint8_t>> nines;
+    for (const Puzzle& puzzle : corpus)
+    {
+        nines.emplace_back(puzzle.begin(), puzzle.end());
+    }
+    //Fixed seed, so a failure can be repeated
+    mt19937_64 rng(2024);
+    vector<vector<uint8_t>> fours = makePuzzles<2>(50, 0.7, rng);
+    vector<vector<uint8_t>> sixteens = makePuzzles<4>(10, 0.5, rng);
+
+    if (cpuHasAvx2())
+    {
+        //Wrong clues cover the givens found to clash, and the lanes of a lockstep group with no solution
+        //while the others go on
+        vector<vector<uint8_t>> wrongFours = withWrongClues<2>(fours, rng);
+        vector<vector<uint8_t>> wrongNines = withWrongClues<3>(nines, rng);
+        vector<vector<uint8_t>> wrongSixteens = withWrongClues<4>(sixteens, rng);
+        checkSimd<2>(wrongFours);
+        checkSimd<3>(wrongNines);
+        checkSimd<4>(wrongSixteens);
+        cout << "simd: done\n";
+#ifdef HAVE_AVX2_KERNELS
+        checkLockstep<2>(wrongFours);
+        checkLockstep<3>(wrongNines);
+        checkLockstep<4>(wrongSixteens);
+        cout << "lockstep: done\n";
+#endif
+    }
+    else
+    {
+        cout << "simd: skipped, the CPU has no AVX2\n";
+    }
+    //The empty board and other puzzles with many solutions are counted up to the limit
+    checkReuse<2>(fours, 0);
+    checkReuse<3>(nines, 100);
+    cout << "reuse: done\n";
+    checkCache(corpus, rng);
+    cout << "cache: done\n";
+    checkBackjump<2>(fours, 0);
+    checkBackjump<3>(nines, 100);
+    cout << "backjump: done\n";
+
+    if (failures > 0)
+    {
+        cerr << failures << " checks failed\n";
+        return 1;
+    }
+    cout << "All checks passed\n";
+    return 0;
+}
@@ -0,0 +1,440 @@
+#!/bin/bash
+# Checks of the sudoku program: each one runs it on small puzzles and checks what it writes
+# Run from the folder of the repository, after building: tests/check.sh [program]
+
+program=$(realpath "${1:-./sudoku}")
+tests=$(realpath "$(dirname "$0")")
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+failures=0
+
+# Reports a failed check
+fail()
+{
+    echo "FAIL $1"
+    failures=$((failures + 1))
+}
+
+# Compares 2 board files, ignoring the spaces and line endings at the ends of lines
+same()
+{
+    cmp -s <(sed 's/[ \r]*$//' "$1") <(sed 's/[ \r]*$//' "$2")
+}
+
+# Prints the digits of a board file, in any of its formats, with 0 for a blank cell
+digits()
+{
+    tr '.' '0' < "$1" | tr -cd '0-9'
+}
+
+# Returns true if the 9x9 board in the solution file solves the one in the puzzle file:
+# it keeps the given digits and has each digit once in every row, column and grid
+solves()
+{
+    awk -v puzzle="$(digits "$1")" -v solution="$(digits "$2")" 'BEGIN {
+        if (length(puzzle) != 81 || length(solution) != 81) exit 1
+        for (i = 0; i < 81; ++i) {
+            p = substr(puzzle, i + 1, 1); s = substr(solution, i + 1, 1)
+            if (s == "0" || (p != "0" && p != s)) exit 1
+            r = int(i / 9); c = i % 9; g = int(r / 3) * 3 + int(c / 3)
+            if (row[r, s]++ || col[c, s]++ || grid[g, s]++) exit 1
+        }
+    }'
+}
+
+# Prints a puzzle given in the 1 line format in the 9 line format
+board()
+{
+    echo "$1" | tr '.' '0' | sed 's/./& /g' | fold -w 18
+}
+
+# Prints a solved board with boxes of the given width, in the line by line format, with every
+# cell where (7 * row + 3 * column) % k is 0 blanked
+pattern()
+{
+    awk -v box="$1" -v k="$2" 'BEGIN {
+        n = box * box
+        for (r = 0; r < n; ++r) {
+            line = ""
+            for (c = 0; c < n; ++c) {
+                v = (box * (r % box) + int(r / box) + c) % n + 1
+                line = line (c ? " " : "") ((7 * r + 3 * c) % k ? v : 0)
+            }
+            print line
+        }
+    }'
+}
+
+# Returns true if the board in the solution file solves the one in the puzzle file, both in the
+# line by line format with boxes of the given width
+fits()
+{
+    awk -v box="$1" 'FNR == 1 { ++file } { for (i = 1; i <= NF; ++i) cell[file, n[file]++] = $i }
+    END {
+        size = box * box
+        if (n[1] != size * size || n[2] != size * size) exit 1
+        for (i = 0; i < size * size; ++i) {
+            p = cell[1, i]; s = cell[2, i]
+            if (s < 1 || s > size || (p != 0 && p != s)) exit 1
+            r = int(i / size); c = i % size; g = int(r / box) * box + int(c / box)
+            if (row[r, s]++ || col[c, s]++ || grid[g, s]++) exit 1
+        }
+    }' "$2" "$3"
+}
+
+# Runs the program the way it runs by default, from Input1.txt to Output1.txt in the work folder,
+# on the puzzle file, with the given options, and prints what it prints
+solve()
+{
+    local puzzle=$1
+    shift
+    cp "$puzzle" "$work/Input1.txt" && (cd "$work" && "$program" "$@")
+}
+
+# Input1.txt is solved as in Output1.txt
+solve Input1.txt > "$work/log" && grep -q "Result: true" "$work/log" &&
+    same "$work/Output1.txt" Output1.txt || fail "Input1.txt is not solved as in Output1.txt"
+
+# Givens that clash in a row, a column or a grid have no solution
+sed '1s/^0/5/' Input1.txt > "$work/row.txt"
+sed '1s/^0/6/' Input1.txt > "$work/column.txt"
+sed '1s/^0/8/' Input1.txt > "$work/grid.txt"
+for puzzle in row column grid; do
+    solve "$work/$puzzle.txt" | grep -q "Result: false" || fail "$puzzle.txt is solved"
+done
+
+# Every propagation mode solves Input1.txt the same way; without propagation, hard puzzles take too long
+for mode in none forward ac3; do
+    solve Input1.txt --propagate $mode > /dev/null && same "$work/Output1.txt" Output1.txt ||
+        fail "Input1.txt is not solved as in Output1.txt with --propagate $mode"
+done
+for mode in forward ac3; do
+    solve "$tests/hard.txt" --propagate $mode > /dev/null && solves "$tests/hard.txt" "$work/Output1.txt" ||
+        fail "hard.txt is not solved with --propagate $mode"
+    solve "$tests/stuck.txt" --propagate $mode | grep -q "Result: false" ||
+        fail "stuck.txt, where a cell has no value left, is solved with --propagate $mode"
+done
+
+# Every logic mode solves hard.txt, and the logic rules alone solve Input1.txt
+for mode in off pre node; do
+    for propagation in forward ac3; do
+        solve "$tests/hard.txt" --logic $mode --propagate $propagation > /dev/null &&
+            solves "$tests/hard.txt" "$work/Output1.txt" || fail "hard.txt is not solved with --logic $mode --propagate $propagation"
+    done
+done
+solve Input1.txt --logic pre | grep -q "Cells left for the search after logic: 0" ||
+    fail "the logic rules leave cells of Input1.txt for the search"
+
+# The puzzles of puzzles.txt are solved without the logic rules, by the search alone, and with them at every node
+while read -r line; do
+    board "$line" > "$work/puzzle.txt"
+    for mode in off node; do
+        for propagation in forward ac3; do
+            solve "$work/puzzle.txt" --logic $mode --propagate $propagation > /dev/null &&
+                solves "$work/puzzle.txt" "$work/Output1.txt" ||
+                fail "$line is not solved with --logic $mode --propagate $propagation"
+        done
+    done
+done < "$tests/puzzles.txt"
+
+# Puzzles with 17 clues and the empty board, where the degree heuristic picks most of the cells, are solved
+while read -r line; do
+    board "$line" > "$work/puzzle.txt"
+    for propagation in forward ac3; do
+        solve "$work/puzzle.txt" --propagate $propagation > /dev/null && solves "$work/puzzle.txt" "$work/Output1.txt" ||
+            fail "$line is not solved with --propagate $propagation"
+    done
+done < "$tests/sparse.txt"
+
+# The same seed gives the same search, and the seed printed by a run without one reproduces it
+board "$(tail -n 1 "$tests/sparse.txt")" > "$work/empty.txt"
+solve "$work/empty.txt" --seed 12345 > "$work/first.log" && cp "$work/Output1.txt" "$work/first.txt"
+solve "$work/empty.txt" --seed 12345 > "$work/second.log"
+cmp -s "$work/first.log" "$work/second.log" && cmp -s "$work/first.txt" "$work/Output1.txt" ||
+    fail "the same seed gives different solutions of the empty board"
+solve "$work/empty.txt" > "$work/first.log" && cp "$work/Output1.txt" "$work/first.txt"
+seed=$(sed -n 's/^Seed: //p' "$work/first.log")
+solve "$work/empty.txt" --seed "$seed" > "$work/second.log"
+[ -n "$seed" ] && cmp -s "$work/first.log" "$work/second.log" && cmp -s "$work/first.txt" "$work/Output1.txt" ||
+    fail "the printed seed does not reproduce the run"
+solve "$work/empty.txt" --tiebreak first > "$work/first.log"
+grep -q "Seed:" "$work/first.log" && fail "--tiebreak first prints a seed it does not use"
+
+# Batch mode solves every puzzle of a file, in both formats, in order
+(cat Input1.txt; echo; head -n 1 "$tests/puzzles.txt"; echo; cat "$tests/hard.txt") > "$work/mixed.txt"
+"$program" --batch "$work/mixed.txt" "$work/mixed.out" > /dev/null
+solved=$(digits "$work/mixed.out")
+[ "${solved:0:81}" = "$(digits Output1.txt)" ] &&
+    solves <(head -n 1 "$tests/puzzles.txt") <(echo "${solved:81:81}") &&
+    solves "$tests/hard.txt" <(echo "${solved:162:81}") || fail "batch mode does not solve the puzzles of both formats"
+"$program" --batch "$tests/puzzles.txt" "$work/batch.txt" > /dev/null
+while read -r puzzle solution; do
+    solves <(echo "$puzzle") <(echo "$solution") || fail "$puzzle is not solved in batch mode"
+done < <(paste -d ' ' "$tests/puzzles.txt" "$work/batch.txt")
+
+# Puzzle i of a batch is searched as a single puzzle with the seed plus i, on any number of threads,
+# and the seed is in the summary line when the search uses it
+"$program" --batch --seed 100 --threads 1 "$tests/sparse.txt" "$work/first.txt" > "$work/first.log"
+"$program" --batch --seed 100 --threads 4 "$tests/sparse.txt" "$work/second.txt" > /dev/null
+cmp -s "$work/first.txt" "$work/second.txt" || fail "batch mode gives different solutions on 1 and 4 threads"
+grep -q ", seed 100" "$work/first.log" || fail "the batch summary has no seed"
+i=0
+while read -r line; do
+    board "$line" > "$work/puzzle.txt"
+    solve "$work/puzzle.txt" --seed $((100 + i)) > /dev/null
+    i=$((i + 1))
+    [ "$(digits "$work/Output1.txt")" = "$(sed -n "${i}p" "$work/first.txt")" ] ||
+        fail "$line is solved differently in batch mode"
+done < "$tests/sparse.txt"
+"$program" --batch --tiebreak first "$tests/sparse.txt" "$work/first.txt" | grep -q "seed" &&
+    fail "the batch summary has a seed with --tiebreak first"
+
+# A file of more puzzles than batch mode holds at a time, and more bytes than it reads at a time,
+# keeps its order; line endings of Windows are read as well
+# Every 4096th puzzle is one of puzzles.txt, the others are Output1.txt with a cell blanked
+solution=$(digits Output1.txt)
+for i in $(seq 0 20479); do
+    if [ $((i % 4096)) -eq 4095 ]; then
+        sed -n "$((i / 4096 + 1))p" "$tests/puzzles.txt"
+    else
+        echo "${solution:0:$((i % 81))}.${solution:$((i % 81 + 1))}"
+    fi
+done > "$work/many.txt"
+"$program" --batch "$work/many.txt" "$work/many.out" | grep -q "Solved 20480 of 20480 puzzles" &&
+    [ "$(wc -l < "$work/many.out")" -eq 20480 ] &&
+    [ "$(awk 'NR % 4096 != 0' "$work/many.out" | sort -u)" = "$solution" ] &&
+    cmp -s <(awk 'NR % 4096 == 0' "$work/many.out") <(head -n 5 "$work/batch.txt") ||
+    fail "batch mode does not solve a file of 20480 puzzles in order"
+sed 's/$/\r/' "$tests/puzzles.txt" > "$work/windows.txt"
+"$program" --batch "$work/windows.txt" "$work/windows.out" > /dev/null
+cmp -s "$work/windows.out" "$work/batch.txt" || fail "batch mode reads lines that end in \\r\\n differently"
+
+# Blanking the 4 cells of a rectangle of 2 digits in Output1.txt leaves 2 solutions; Input1.txt has 1,
+# and counting does not stop before the limit
+awk 'NR <= 2 { $3 = 0; $4 = 0 } { print }' Output1.txt > "$work/rectangle.txt"
+solve "$work/rectangle.txt" --count 0 | grep -q "Solutions: 2" || fail "the rectangle does not have 2 solutions"
+solve "$work/rectangle.txt" --count 1 | grep -q "Solutions: 1" || fail "--count 1 does not stop at 1 solution"
+solve Input1.txt --count 0 | grep -q "Solutions: 1" || fail "Input1.txt does not have 1 solution"
+solve "$tests/stuck.txt" --count 0 | grep -q "^Solutions: 0$" || fail "stuck.txt does not have 0 solutions, with no limit"
+(digits "$work/rectangle.txt"; echo; digits Input1.txt; echo) > "$work/counts.txt"
+"$program" --batch --count 0 "$work/counts.txt" "$work/counts.out" > /dev/null
+[ "$(tr '\n' ' ' < "$work/counts.out")" = "2 1 " ] || fail "batch mode does not write the number of solutions"
+
+# The exact cover engine finds the same solutions and counts as the default one
+for puzzle in puzzles sparse; do
+    "$program" --batch --engine dlx "$tests/$puzzle.txt" "$work/dlx.txt" > /dev/null
+    while read -r line solution; do
+        solves <(echo "$line") <(echo "$solution") || fail "$line is not solved with --engine dlx"
+    done < <(paste -d ' ' "$tests/$puzzle.txt" "$work/dlx.txt")
+done
+for engine in csp dlx; do
+    "$program" --batch --engine $engine --count 0 "$work/counts.txt" "$work/$engine.txt" > /dev/null
+done
+cmp -s "$work/csp.txt" "$work/dlx.txt" || fail "--engine dlx counts solutions differently"
+for puzzle in Input1.txt "$work/rectangle.txt" "$tests/stuck.txt"; do
+    solve "$puzzle" --engine dlx --count 0 | grep "Solutions:" > "$work/dlx.log"
+    solve "$puzzle" --engine csp --count 0 | grep "Solutions:" > "$work/csp.log"
+    cmp -s "$work/csp.log" "$work/dlx.log" || fail "$(basename "$puzzle") has different counts with each engine"
+done
+solve Input1.txt --engine dlx > /dev/null && same "$work/Output1.txt" Output1.txt ||
+    fail "Input1.txt is not solved as in Output1.txt with --engine dlx"
+solve "$work/row.txt" --engine dlx | grep -q "Result: false" || fail "row.txt is solved with --engine dlx"
+
+# Every size of board is solved, and both engines count its solutions alike: 288 for the empty 4x4 board
+pattern 2 1 > "$work/empty4.txt"
+for engine in csp dlx; do
+    solve "$work/empty4.txt" --size 4 --engine $engine --count 0 | grep -q "Solutions: 288" ||
+        fail "the empty 4x4 board does not have 288 solutions with --engine $engine"
+done
+# The 25x25 board with a third of its cells blanked has so many solutions that some seeds take the csp
+# engine minutes to find one, so it only has the pattern with half of its cells blanked, which has one
+for board in "2 2" "2 3" "3 2" "3 3" "4 2" "4 3" "5 2"; do
+    read -r box k <<< "$board"
+    size=$((box * box))
+    pattern $box $k > "$work/pattern.txt"
+    for engine in csp dlx; do
+        solve "$work/pattern.txt" --size $size --engine $engine > /dev/null &&
+            fits $box "$work/pattern.txt" "$work/Output1.txt" ||
+            fail "the ${size}x$size board $k is not solved with --engine $engine"
+        solve "$work/pattern.txt" --size $size --engine $engine --count 100 | grep "Solutions:" > "$work/$engine.log"
+    done
+    cmp -s "$work/csp.log" "$work/dlx.log" || fail "the engines count the solutions of the ${size}x$size board $k differently"
+done
+
+# A search that goes through thousands of solutions, or as deep as the 625 cells of the empty 25x25
+# board, ends with the same result as the exact cover engine
+for n in 3 6 9; do
+    sed "1!d; s/[1-9]/./$n; s/[1-9]/./$((n + 1))" "$tests/puzzles.txt"
+done > "$work/loose.txt"
+for engine in csp dlx; do
+    "$program" --batch --engine $engine --count 0 "$work/loose.txt" "$work/$engine.txt" > /dev/null
+done
+[ "$(tr '\n' ' ' < "$work/csp.txt")" = "847 1998 2808 " ] && cmp -s "$work/csp.txt" "$work/dlx.txt" ||
+    fail "the engines do not count the 847, 1998 and 2808 solutions of loose.txt"
+pattern 5 1 > "$work/empty25.txt"
+solve "$work/empty25.txt" --size 25 --tiebreak first > /dev/null && fits 5 "$work/empty25.txt" "$work/Output1.txt" ||
+    fail "the empty 25x25 board is not solved"
+
+# The AVX2 kernels find the same solutions, and fire the same logic rules, as the scalar code
+# they stand in for, on every board size they cover
+pattern 2 2 > "$work/simd4.txt"
+pattern 4 2 > "$work/simd16.txt"
+pattern 4 3 > "$work/simd16-3.txt"
+i=0
+while read -r line; do
+    board "$line" > "$work/simd9-$((++i)).txt"
+done < "$tests/puzzles.txt"
+for puzzle in "$work"/simd*.txt "$tests/hard.txt"; do
+    size=$(wc -l < "$puzzle")
+    for mode in off pre node; do
+        for propagation in forward ac3; do
+            for simd in off auto; do
+                solve "$puzzle" --size $size --seed 7 --logic $mode --propagate $propagation --simd $simd > "$work/$simd.log"
+                cp "$work/Output1.txt" "$work/$simd.txt"
+            done
+            cmp -s "$work/off.log" "$work/auto.log" && cmp -s "$work/off.txt" "$work/auto.txt" ||
+                fail "$(basename "$puzzle") is solved differently by the AVX2 kernels with --logic $mode --propagate $propagation"
+        done
+    done
+done
+"$program" --batch --simd off "$tests/puzzles.txt" "$work/off.txt" > /dev/null
+"$program" --batch --simd auto "$tests/puzzles.txt" "$work/auto.txt" > /dev/null
+cmp -s "$work/off.txt" "$work/auto.txt" || fail "batch mode solves differently with the AVX2 kernels"
+
+# The benchmark reports a row per corpus and configuration, in CSV and in JSON, with the same counts
+bench=$(realpath "$tests/../bench")
+for format in csv json; do
+    "$program" --bench "$bench/hard.txt" --bench "$bench/pathological.txt" --configs csp-ac3-node,dlx \
+        --repeat 2 --warmup 1 --seed 3 --format $format > "$work/bench.$format"
+done
+printf '%s\n' corpus,config,seed,puzzles,repeats,solved hard,csp-ac3-node,3,7,2,7 hard,dlx,3,7,2,7 \
+    pathological,csp-ac3-node,3,4,2,3 pathological,dlx,3,4,2,3 > "$work/expected.csv"
+cmp -s <(cut -d , -f 1-6 "$work/bench.csv") "$work/expected.csv" ||
+    fail "the benchmark CSV does not have a row per corpus and configuration"
+sed -n 's/.*"corpus": "\([^"]*\)", "config": "\([^"]*\)", "seed": \([0-9]*\), "puzzles": \([0-9]*\), "repeats": \([0-9]*\), "solved": \([0-9]*\),.*/\1,\2,\3,\4,\5,\6/p' \
+    "$work/bench.json" > "$work/json.csv"
+cmp -s <(tail -n +2 "$work/expected.csv") "$work/json.csv" || fail "the benchmark JSON does not have the rows of the CSV"
+
+# The stats file has a row per puzzle, searched with the seed plus its index, and the same seed gives
+# the same counters on any number of threads and with or without the AVX2 kernels,
+# when the search counters are compiled in (SEARCH_STATS=1)
+if "$program" --batch --stats "$work/probe.csv" "$tests/puzzles.txt" "$work/probe.txt" > /dev/null 2>&1; then
+    "$program" --batch --seed 5 --threads 1 --stats "$work/first.csv" "$tests/puzzles.txt" "$work/first.txt" > /dev/null
+    "$program" --batch --seed 5 --threads 4 --stats "$work/second.csv" "$tests/puzzles.txt" "$work/second.txt" > /dev/null
+    "$program" --batch --seed 5 --simd off --stats "$work/scalar.csv" "$tests/puzzles.txt" "$work/scalar.txt" > /dev/null
+    [ "$(cut -d , -f 1-3 "$work/first.csv" | tr '\n' ' ')" = "puzzle,seed,solutions 0,5,1 1,6,1 2,7,1 3,8,1 4,9,1 " ] ||
+        fail "the stats file does not have a row per puzzle"
+    cmp -s "$work/first.csv" "$work/second.csv" && cmp -s "$work/first.csv" "$work/scalar.csv" ||
+        fail "the same seed gives different stats"
+    solve Input1.txt --seed 3 --stats stats.csv > /dev/null
+    [ "$(cut -d , -f 1-3 "$work/stats.csv" | tr '\n' ' ')" = "puzzle,seed,solutions 0,3,1 " ] ||
+        fail "the stats file of a single puzzle does not have its row"
+fi
+
+# A search that runs out of its budget is reported as aborted, in batch mode in place of the solution,
+# and a single puzzle is written back as it was given
+"$program" --batch --seed 1 --node-limit 5 "$tests/puzzles.txt" "$work/aborted.txt" > "$work/aborted.log"
+grep -q "Solved 3 of 5 puzzles, 2 aborted" "$work/aborted.log" &&
+    [ "$(grep -c "^Aborted$" "$work/aborted.txt")" -eq 2 ] || fail "--node-limit does not abort the search"
+"$program" --batch --seed 1 --node-limit 5 --count 0 "$tests/puzzles.txt" "$work/aborted.txt" > /dev/null
+[ "$(grep -c "^0 aborted$" "$work/aborted.txt")" -eq 2 ] || fail "--node-limit does not abort the count"
+"$program" --batch --backtrack-limit 1 --engine dlx "$tests/puzzles.txt" "$work/aborted.txt" |
+    grep -q "Solved 0 of 5 puzzles, 5 aborted" || fail "--backtrack-limit does not abort the exact cover search"
+solve "$tests/hard.txt" --node-limit 2 | grep -q "^Aborted:" && same "$work/Output1.txt" "$tests/hard.txt" ||
+    fail "an aborted puzzle is not written back as it was given"
+
+# Puzzles whose digits are relabeled are answered from the cache, with the solutions the search finds;
+# a cache too small for the puzzles in between has no hits, and a cache file keeps them for the next run
+(cat "$bench/hard.txt"; tr '123456789' '912345678' < "$bench/hard.txt") > "$work/relabeled.txt"
+"$program" --batch --threads 1 "$work/relabeled.txt" "$work/searched.txt" > /dev/null
+"$program" --batch --threads 1 --cache "$work/relabeled.txt" "$work/cached.txt" | grep -q ", 7 from the cache" &&
+    cmp -s "$work/searched.txt" "$work/cached.txt" || fail "relabeled puzzles are not answered from the cache"
+"$program" --batch --threads 1 --cache --cache-size 6 "$work/relabeled.txt" "$work/cached.txt" |
+    grep -q ", 0 from the cache" || fail "--cache-size does not limit the cache"
+"$program" --batch --cache-file "$work/cache.bin" "$bench/hard.txt" "$work/cached.txt" > /dev/null
+"$program" --batch --cache-file "$work/cache.bin" "$bench/hard.txt" "$work/cached.txt" | grep -q ", 7 from the cache" &&
+    cmp -s <(head -n 7 "$work/searched.txt") "$work/cached.txt" || fail "--cache-file does not keep the cache between runs"
+
+# A search split across threads counts the same solutions as one that is not, and solves the puzzle
+while read -r line; do
+    board "$line" > "$work/puzzle.txt"
+    solve "$work/puzzle.txt" --count 0 | grep "Solutions:" > "$work/whole.log"
+    for depth in 1 3 6; do
+        solve "$work/puzzle.txt" --split $depth --threads 4 --count 0 2> /dev/null | grep "Solutions:" > "$work/split.log"
+        cmp -s "$work/whole.log" "$work/split.log" || fail "$line has a different count with --split $depth"
+    done
+done < "$work/loose.txt"
+solve "$tests/hard.txt" --split 3 --threads 4 > /dev/null 2>&1 && solves "$tests/hard.txt" "$work/Output1.txt" ||
+    fail "hard.txt is not solved with --split 3"
+solve "$work/empty.txt" --split 2 --threads 4 --count 100 2> /dev/null | grep -q "Solutions: 100 (limit reached)" ||
+    fail "the threads of --split do not stop at the limit between them"
+
+# Least constraining value ordering finds the same solutions and counts as the natural order
+for order in natural lcv; do
+    "$program" --batch --order $order "$tests/puzzles.txt" "$work/$order.txt" > /dev/null
+    "$program" --batch --order $order --count 0 "$work/loose.txt" "$work/$order-counts.txt" > /dev/null
+done
+cmp -s "$work/natural.txt" "$work/lcv.txt" && cmp -s "$work/natural-counts.txt" "$work/lcv-counts.txt" ||
+    fail "--order lcv finds different solutions or counts"
+for mode in off node; do
+    solve "$tests/hard.txt" --order lcv --logic $mode > /dev/null && solves "$tests/hard.txt" "$work/Output1.txt" ||
+        fail "hard.txt is not solved with --order lcv --logic $mode"
+done
+
+# The backjumping search, with and without nogoods, counts the same solutions as the exact cover engine
+for nogoods in 0 64; do
+    "$program" --batch --backjump --nogoods $nogoods --count 0 "$work/loose.txt" "$work/backjump.txt" > /dev/null
+    [ "$(tr '\n' ' ' < "$work/backjump.txt")" = "847 1998 2808 " ] ||
+        fail "--backjump --nogoods $nogoods counts the solutions of loose.txt differently"
+    "$program" --batch --backjump --nogoods $nogoods "$tests/puzzles.txt" "$work/backjump.txt" > /dev/null
+    cmp -s "$work/batch.txt" "$work/backjump.txt" || fail "--backjump --nogoods $nogoods solves differently"
+    solve "$tests/stuck.txt" --backjump --nogoods $nogoods | grep -q "Result: false" ||
+        fail "stuck.txt is solved with --backjump --nogoods $nogoods"
+done
+
+# The server answers each request line as batch mode would with the same seed, an invalid request with an
+# error line, and a request ending in stats with the search counters
+"$program" --serve --seed 5 < "$tests/sparse.txt" > "$work/served.txt" 2> /dev/null
+"$program" --batch --seed 5 "$tests/sparse.txt" "$work/batch-sparse.txt" > /dev/null
+cmp -s "$work/served.txt" "$work/batch-sparse.txt" || fail "the server answers differently from batch mode"
+(echo 123; head -n 1 "$tests/puzzles.txt" | sed 's/$/ stats/') | "$program" --serve 2> /dev/null > "$work/served.txt"
+sed -n 1p "$work/served.txt" | grep -q "^Error: " || fail "the server does not answer an invalid request with an error"
+sed -n 2p "$work/served.txt" | grep -q "^$(head -n 1 "$work/batch.txt") nodes=[0-9]* " ||
+    fail "the server does not answer a request for stats with its counters"
+
+# Packing and unpacking a corpus gives it back, and batch mode reads and writes packed records with the
+# same results as text
+for corpus in "$bench"/*.txt; do
+    "$program" --pack "$corpus" "$work/corpus.packed" > /dev/null &&
+        "$program" --unpack "$work/corpus.packed" "$work/corpus.unpacked" > /dev/null &&
+        tr . 0 < "$corpus" | cmp -s - "$work/corpus.unpacked" || fail "$(basename "$corpus") is not packed losslessly"
+    "$program" --batch --tiebreak first "$corpus" "$work/text.out" > /dev/null
+    "$program" --batch --tiebreak first "$work/corpus.packed" "$work/packed.out" > /dev/null
+    "$program" --batch --tiebreak first --packed "$corpus" "$work/solutions.packed" > /dev/null
+    "$program" --unpack "$work/solutions.packed" "$work/solutions.unpacked" > /dev/null
+    cmp -s "$work/text.out" "$work/packed.out" && cmp -s "$work/text.out" "$work/solutions.unpacked" ||
+        fail "$(basename "$corpus") is solved differently from packed records"
+done
+
+# Lockstep singles give the same results as solving each puzzle on its own, with and without the AVX2 kernels
+cat "$bench"/*.txt > "$work/feed.txt"
+for options in "" "--count 2" "--engine dlx" "--simd off"; do
+    "$program" --batch --seed 9 $options "$work/feed.txt" "$work/alone.txt" > "$work/alone.log"
+    "$program" --batch --seed 9 --lockstep $options "$work/feed.txt" "$work/lockstep.txt" > "$work/lockstep.log"
+    cmp -s "$work/alone.txt" "$work/lockstep.txt" && cmp -s "$work/alone.log" "$work/lockstep.log" ||
+        fail "--lockstep $options gives different results"
+done
+
+# A cell that is not a digit, and a board with more than 81 cells, are rejected
+sed '1s/^0/x/' Input1.txt > "$work/invalid.txt"
+solve "$work/invalid.txt" > /dev/null 2>&1
+[ $? -eq 4 ] || fail "an invalid cell is not rejected"
+cat Input1.txt Input1.txt > "$work/overflow.txt"
+solve "$work/overflow.txt" > /dev/null 2>&1
+[ $? -eq 2 ] || fail "a board with more than 81 cells is not rejected"
+
+if [ $failures -gt 0 ]; then
+    echo "$failures checks failed"
+    exit 1
+fi
+echo "All checks passed"